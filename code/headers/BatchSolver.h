@@ -0,0 +1,80 @@
+#ifndef FEUP_DA_PROJ2_BATCHSOLVER_H
+#define FEUP_DA_PROJ2_BATCHSOLVER_H
+
+#include <vector>
+
+#include "ExactSolver.h"
+#include "Graph.h"
+#include "ThreadPool.h"
+
+struct BatchOptions {
+    int exactThreshold = 13;    // sub-problems up to this size (at most maxExact) are solved exactly, bigger ones with 2-opt + Or-opt
+    unsigned threads = 0;       // 0 for one per hardware thread
+    int chunk = 64;             // sub-problems handed to a thread at a time
+};
+
+/**
+ * Tour of one sub-problem, in vertex ids of the base graph and starting at the first vertex of the subset.
+ * The cost is -1.0 if the subset has unknown ids or no tour.
+ */
+struct BatchResult {
+    double cost = -1.0;
+    std::vector<int> tour;
+};
+
+/**
+ * Solves many small TSP instances, each a subset of the vertices of one base graph. Every sub-problem is copied into
+ * a distance matrix local to the thread solving it (kept by the thread between sub-problems and batches, so no Graph,
+ * Vertex or Edge is allocated) and solved exactly when small enough (Held-Karp dynamic programming, or the branch and bound of
+ * ExactSolvers for the larger ones), or with nearest neighbour, 2-opt and Or-opt otherwise. The base graph is only read, through calculateDistance.
+ */
+class BatchSolver {
+public:
+    // largest sub-problem solved exactly
+    static const int maxExact = ExactSolvers::maxSize;
+
+    // exact sub-problems up to this size use heldKarp, faster there than the branch and bound of ExactSolvers
+    static const int heldKarpLimit = 12;
+
+    // largest sub-problem heldKarp accepts, using about 90 MB per thread
+    static const int maxHeldKarp = 20;
+
+    /**
+     * Solves every subset in parallel, on a pool with options.threads workers that is created by the first batch
+     * asking for that many and reused by the following ones. \n
+     * Complexity: O(2^k * k²) per sub-problem up to heldKarpLimit, O(k!) in the worst case for the other exact ones,
+     * O(k³) per pass of 2-opt otherwise; k-> size of the subset
+     * @param graph The base graph
+     * @param subsets Lists of vertex ids of the base graph
+     * @param options Threshold for the exact solver, threads and chunk size
+     * @return The results, in the same order as the subsets
+     */
+    static std::vector<BatchResult> solve(Graph &graph, const std::vector<std::vector<int>> &subsets,
+                                          const BatchOptions &options);
+
+    /**
+     * Solves every subset in parallel on the given pool (options.threads is ignored), waiting for these sub-problems
+     * only; the chunks a bounded pool rejects because its queue is full are solved on the calling thread. Must not be
+     * called from a task of the same pool. \n
+     * Complexity: as above
+     * @param pool The pool whose workers solve the chunks of subsets
+     * @return The results, in the same order as the subsets
+     */
+    static std::vector<BatchResult> solve(Graph &graph, const std::vector<std::vector<int>> &subsets,
+                                          const BatchOptions &options, ThreadPool &pool);
+
+    /**
+     * Exact TSP on a k x k distance matrix with the Held-Karp dynamic programming over subsets, from vertex 0. \n
+     * Complexity: O(2^k * k²) time and O(2^k * k) memory in the calling thread's arena
+     * @param matrix Distances between the k vertices
+     * @param tour Filled with the optimal tour
+     * @return The optimal cost, or -1.0 if there is no tour or the matrix is bigger than maxHeldKarp
+     */
+    static double heldKarp(const DistanceMatrix &matrix, std::vector<int> &tour);
+
+private:
+    static void solveOne(Graph &graph, const std::vector<int> &subset, const BatchOptions &options,
+                         BatchResult &result);
+};
+
+#endif //FEUP_DA_PROJ2_BATCHSOLVER_H
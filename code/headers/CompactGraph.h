@@ -0,0 +1,422 @@
+#ifndef FEUP_DA_PROJ2_COMPACTGRAPH_H
+#define FEUP_DA_PROJ2_COMPACTGRAPH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <vector>
+
+#include "Graph.h"
+#include "LocalSearch.h"
+#include "SpatialIndex.h"
+
+/**
+ * Arithmetic used by CompactGraph for each weight type: how a distance is stored, the type used to add weights
+ * together and how both convert back to a distance.
+ */
+template <class W>
+struct WeightTraits;
+
+template <>
+struct WeightTraits<double> {
+    typedef double Sum;
+    static double fromDouble(double d, double) { return d; }
+    static double toDouble(Sum s, double) { return s; }
+};
+
+template <>
+struct WeightTraits<float> {
+    typedef double Sum;
+    static float fromDouble(double d, double) { return (float) d; }
+    static double toDouble(Sum s, double) { return s; }
+};
+
+/**
+ * Fixed point: a distance d is stored as round(d * scale), saturated at the largest 32-bit value so that distances
+ * beyond the range the scale was fitted for (like long Haversine fallbacks) cannot wrap around.
+ */
+template <>
+struct WeightTraits<uint32_t> {
+    typedef int64_t Sum;
+    static uint32_t fromDouble(double d, double scale) {
+        const double largest = std::numeric_limits<uint32_t>::max();
+        double scaled = d * scale;
+        if (!(scaled > 0.0)) return 0;
+        if (scaled >= largest) return std::numeric_limits<uint32_t>::max();
+        return (uint32_t) std::llround(scaled);
+    }
+    static double toDouble(Sum s, double scale) { return (double) s / scale; }
+};
+
+/**
+ * Compact, read-only storage of an undirected graph: adjacency in CSR form with 32-bit vertex ids and weights of
+ * type W (double, float or fixed-point uint32_t), and coordinates stored as floats. Edges are added first and the
+ * structure is built once with build(). Vertex ids are used as indices, so they should be dense, and the 32-bit
+ * offsets store each undirected edge twice, which limits a graph to maxEdges edges.
+ */
+template <class W>
+class CompactGraph {
+public:
+    typedef typename WeightTraits<W>::Sum Sum;
+
+    // largest number of undirected edges, as both directions must be addressable by the 32-bit offsets
+    static const size_t maxEdges = std::numeric_limits<uint32_t>::max() / 2;
+
+    /**
+     * @param scale Scale factor of fixed-point weights (ignored by floating point weights)
+     */
+    explicit CompactGraph(double scale = 1.0) : scale(scale) {}
+
+    /**
+     * Builds the compact version of a graph. \n
+     * Complexity: O(V+E) V-> number of vertices; E-> number of edges
+     * @param graph The graph to convert
+     * @param scale Scale factor of fixed-point weights
+     */
+    static CompactGraph fromGraph(Graph &graph, double scale = 1.0) {
+        CompactGraph res(scale);
+        for (auto v : graph.getVertexSet()) {
+            for (auto e : v->adj) {
+                if (e != nullptr && v->getId() < e->getDest()->getId())
+                    res.addEdge(v->getId(), e->getDest()->getId(), e->getDistance());
+            }
+            if (v->getCoords() != nullptr) res.setCoords(v->getId(), v->getCoords()->longitude, v->getCoords()->latitude);
+        }
+        res.build();
+        return res;
+    }
+
+    /**
+     * Picks the largest power of ten that keeps every weight up to maxWeight inside a 32-bit fixed-point value.
+     */
+    static double fitScale(double maxWeight) {
+        double scale = 1000.0;
+        while (scale > 1e-6 && maxWeight * scale > 4.0e9) scale /= 10.0;
+        return scale;
+    }
+
+    /**
+     * Adds an undirected edge. If the same edge is added twice the first weight is kept, like Vertex::add. \n
+     * Complexity: O(1) amortized
+     */
+    void addEdge(uint32_t u, uint32_t v, double w) {
+        pending.push_back({u, v, WeightTraits<W>::fromDouble(w, scale)});
+        n = std::max(n, std::max(u, v) + 1);
+    }
+
+    /**
+     * Sets the coordinates of a vertex. \n
+     * Complexity: O(1) amortized
+     */
+    void setCoords(uint32_t id, double longitude, double latitude) {
+        if (id >= lon.size()) {
+            lon.resize(id + 1, NAN);
+            lat.resize(id + 1, NAN);
+        }
+        lon[id] = (float) longitude;
+        lat[id] = (float) latitude;
+        n = std::max(n, id + 1);
+    }
+
+    /**
+     * Builds the CSR arrays from the edges added so far, with each adjacency list sorted by destination. \n
+     * Complexity: O(V + E log E) V-> number of vertices; E-> number of edges
+     * @throws std::length_error If more than maxEdges edges were added
+     */
+    void build() {
+        if (pending.size() > maxEdges) throw std::length_error("more edges than the 32-bit offsets can address");
+        offsets.assign(n + 1, 0);
+        for (const Pending &p : pending) {
+            offsets[p.u + 1]++;
+            offsets[p.v + 1]++;
+        }
+        for (uint32_t i = 0; i < n; i++) offsets[i + 1] += offsets[i];
+
+        std::vector<std::pair<uint32_t, W>> entries(offsets[n]);
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (const Pending &p : pending) {
+            entries[fill[p.u]++] = {p.v, p.w};
+            entries[fill[p.v]++] = {p.u, p.w};
+        }
+        std::vector<Pending>().swap(pending);
+
+        targets.clear();
+        weights.clear();
+        targets.reserve(entries.size());
+        weights.reserve(entries.size());
+        auto byTarget = [](const std::pair<uint32_t, W> &a, const std::pair<uint32_t, W> &b) { return a.first < b.first; };
+        uint32_t begin = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t end = offsets[i + 1];
+            std::stable_sort(entries.begin() + begin, entries.begin() + end, byTarget);
+            offsets[i] = (uint32_t) targets.size();
+            for (uint32_t j = begin; j < end; j++) {
+                if (j > begin && entries[j].first == entries[j - 1].first) continue;
+                targets.push_back(entries[j].first);
+                weights.push_back(entries[j].second);
+            }
+            begin = end;
+        }
+        offsets[n] = (uint32_t) targets.size();
+        targets.shrink_to_fit();
+        weights.shrink_to_fit();
+        if (!lon.empty()) {
+            lon.resize(n, NAN);
+            lat.resize(n, NAN);
+        }
+    }
+
+    uint32_t getNumVertex() const { return n; }
+
+    /**
+     * @return The number of undirected edges
+     */
+    size_t getNumEdges() const { return targets.size() / 2; }
+
+    /**
+     * Finds the weight of the edge between u and v. Rows of vertices connected to every other vertex are indexed
+     * directly, unless a self-loop shifts them, which the check of the target found there catches. \n
+     * Complexity: O(log d) d-> degree of u; O(1) on complete graphs
+     * @return True if the edge exists, false otherwise
+     */
+    bool edgeWeight(uint32_t u, uint32_t v, W &w) const {
+        if (offsets[u + 1] - offsets[u] == n - 1 && u != v) {
+            uint32_t slot = offsets[u] + v - (v > u);
+            if (targets[slot] == v) {
+                w = weights[slot];
+                return true;
+            }
+        }
+        auto first = targets.begin() + offsets[u], last = targets.begin() + offsets[u + 1];
+        auto it = std::lower_bound(first, last, v);
+        if (it == last || *it != v) return false;
+        w = weights[it - targets.begin()];
+        return true;
+    }
+
+    /**
+     * Distance between two vertices: the edge weight if there is an edge, the Haversine distance (in the same weight
+     * type) if both vertices have coordinates. \n
+     * Complexity: O(log d) d-> degree of u
+     * @return True if the distance is known, false otherwise
+     */
+    bool distance(uint32_t u, uint32_t v, Sum &d) const {
+        W w;
+        if (edgeWeight(u, v, w)) {
+            d = (Sum) w;
+            return true;
+        }
+        if (u >= lon.size() || v >= lon.size() || std::isnan(lon[u]) || std::isnan(lon[v])) return false;
+        d = (Sum) WeightTraits<W>::fromDouble(haversine(u, v), scale);
+        return true;
+    }
+
+    /**
+     * Converts a weight or sum of weights back to a distance.
+     */
+    double toDouble(Sum s) const { return WeightTraits<W>::toDouble(s, scale); }
+
+    /**
+     * Weight of the Minimum Spanning Tree containing vertex 0, using Prim's algorithm with a lazy heap. \n
+     * Complexity: O(E log V) E-> number of edges; V-> number of vertices
+     * @param parent Filled, for each vertex, with its parent in the tree (-1 for the root and unreachable vertices)
+     * @return The total weight of the tree
+     */
+    Sum mstPrim(std::vector<int64_t> &parent) const {
+        typedef std::pair<W, uint32_t> Item;    // key, vertex
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> q;
+        std::vector<bool> inTree(n, false);
+        std::vector<W> key(n);
+        parent.assign(n, -1);
+        Sum total = 0;
+        if (n == 0) return total;
+
+        // a vertex is pushed again only when its key decreases, stale entries are skipped
+        q.push({W(), 0});
+        while (!q.empty()) {
+            Item item = q.top();
+            q.pop();
+            uint32_t u = item.second;
+            if (inTree[u]) continue;
+            inTree[u] = true;
+            total += (Sum) item.first;
+            for (uint32_t j = offsets[u]; j < offsets[u + 1]; j++) {
+                uint32_t v = targets[j];
+                if (inTree[v] || (v != 0 && parent[v] != -1 && !(weights[j] < key[v]))) continue;
+                key[v] = weights[j];
+                parent[v] = u;
+                q.push({weights[j], v});
+            }
+        }
+        return total;
+    }
+
+    /**
+     * Nearest neighbour tour from vertex 0, following edges only. \n
+     * Complexity: O(V+E) V-> number of vertices; E-> number of edges
+     * @param tour Filled with the tour found
+     * @param cost Filled with the cost of the tour
+     * @return False if the tour got stuck or cannot be closed
+     */
+    bool nearestNeighbour(std::vector<uint32_t> &tour, Sum &cost) const {
+        std::vector<bool> visited(n, false);
+        tour.assign(1, 0);
+        visited[0] = true;
+        cost = 0;
+
+        uint32_t curr = 0;
+        while (tour.size() < n) {
+            int64_t next = -1;
+            W best = W();
+            for (uint32_t j = offsets[curr]; j < offsets[curr + 1]; j++) {
+                if (!visited[targets[j]] && (next == -1 || weights[j] < best)) {
+                    best = weights[j];
+                    next = targets[j];
+                }
+            }
+            if (next == -1) return false;
+            cost += (Sum) best;
+            visited[next] = true;
+            tour.push_back((uint32_t) next);
+            curr = (uint32_t) next;
+        }
+
+        Sum closing;
+        if (!distance(tour.back(), tour.front(), closing)) return false;
+        cost += closing;
+        return true;
+    }
+
+    /**
+     * Builds, for each vertex, a list of its k closest vertices, like Graph::candidateLists: from a spatial grid if
+     * every vertex has coordinates, otherwise from its k lightest edges. \n
+     * Complexity: O(V*k log k) with coordinates, O(V+E) otherwise
+     * @return Vector, indexed by vertex id, with the ids of the candidates sorted by distance
+     */
+    std::vector<std::vector<uint32_t>> candidateLists(int k) const {
+        std::vector<std::vector<uint32_t>> candidates(n);
+        if (hasCoords()) {
+            SpatialIndex index(points());
+            for (uint32_t i = 0; i < n; i++) {
+                for (int j : index.nearest((int) i, k)) candidates[i].push_back((uint32_t) j);
+            }
+            return candidates;
+        }
+
+        std::vector<std::pair<W, uint32_t>> row;
+        for (uint32_t u = 0; u < n; u++) {
+            row.clear();
+            for (uint32_t j = offsets[u]; j < offsets[u + 1]; j++) {
+                if (targets[j] != u) row.push_back({weights[j], targets[j]});
+            }
+            if (row.size() > (size_t) k) {
+                std::nth_element(row.begin(), row.begin() + k, row.end());
+                row.resize(k);
+            }
+            std::sort(row.begin(), row.end());
+            for (auto &entry : row) candidates[u].push_back(entry.second);
+        }
+        return candidates;
+    }
+
+    /**
+     * Tour along a Hilbert curve over the coordinates, closing the gaps between vertices with no edge by Haversine
+     * distances like distance(). \n
+     * Complexity: O(V log V + V log d) V-> number of vertices; d-> maximum degree
+     * @param tour Filled with the tour found
+     * @param cost Filled with the cost of the tour
+     * @return False if some vertex has no coordinates
+     */
+    bool spaceFillingCurve(std::vector<uint32_t> &tour, Sum &cost) const {
+        if (!hasCoords()) return false;
+        tour.clear();
+        for (int i : SpatialIndex::hilbertOrder(points())) tour.push_back((uint32_t) i);
+        // the tour starts at vertex 0, like nearestNeighbour
+        std::rotate(tour.begin(), std::find(tour.begin(), tour.end(), 0u), tour.end());
+
+        cost = 0;
+        for (size_t i = 0; i < tour.size(); i++) {
+            Sum d;
+            if (!distance(tour[i], tour[(i + 1) % tour.size()], d)) return false;
+            cost += d;
+        }
+        return true;
+    }
+
+    /**
+     * Nearest neighbour, or the space-filling curve when the nearest neighbour gets stuck (as on sparse k-nearest
+     * graphs), followed by the candidate list 2-opt shared with Graph::tspHeuristic (LocalSearch::twoOptCandidates),
+     * with the arithmetic of W. \n
+     * Complexity: O(V*k log d) per improving move V-> number of vertices; k-> candidates; d-> maximum degree
+     * @param tour Filled with the tour found
+     * @param cost Filled with the cost of the tour
+     * @param k Number of candidates per vertex
+     * @return False if no tour was found
+     */
+    bool tspHeuristic(std::vector<uint32_t> &tour, Sum &cost, int k = 10) const {
+        if (!nearestNeighbour(tour, cost) && !spaceFillingCurve(tour, cost)) return false;
+        auto lookup = [this](uint32_t u, uint32_t v, Sum &d) { return distance(u, v, d); };
+        cost = LocalSearch::twoOptCandidates(tour, candidateLists(k), lookup, cost);
+        return true;
+    }
+
+    /**
+     * @return The bytes held by the adjacency, weights and coordinates
+     */
+    size_t memoryBytes() const {
+        return offsets.capacity() * sizeof(uint32_t) + targets.capacity() * sizeof(uint32_t) +
+               weights.capacity() * sizeof(W) + (lon.capacity() + lat.capacity()) * sizeof(float);
+    }
+
+    /**
+     * @return The bytes of adjacency and weights per undirected edge
+     */
+    double bytesPerEdge() const {
+        if (getNumEdges() == 0) return 0;
+        return (double) (offsets.capacity() * sizeof(uint32_t) + targets.capacity() * sizeof(uint32_t) +
+                         weights.capacity() * sizeof(W)) / getNumEdges();
+    }
+
+private:
+    struct Pending {
+        uint32_t u, v;
+        W w;
+    };
+
+    bool hasCoords() const {
+        if (n == 0 || lon.size() != n) return false;
+        for (uint32_t i = 0; i < n; i++) {
+            if (std::isnan(lon[i]) || std::isnan(lat[i])) return false;
+        }
+        return true;
+    }
+
+    std::vector<Coords> points() const {
+        std::vector<Coords> res(n);
+        for (uint32_t i = 0; i < n; i++) res[i] = {lon[i], lat[i]};
+        return res;
+    }
+
+    double haversine(uint32_t u, uint32_t v) const {
+        double lat1 = lat[u] * M_PI / 180.0, lat2 = lat[v] * M_PI / 180.0;
+        double deltaLat = lat2 - lat1;
+        double deltaLon = (lon[v] - lon[u]) * M_PI / 180.0;
+        double aux = std::sin(deltaLat / 2.0) * std::sin(deltaLat / 2.0) +
+                     std::cos(lat1) * std::cos(lat2) * std::sin(deltaLon / 2.0) * std::sin(deltaLon / 2.0);
+        return 6371000.0 * 2.0 * std::atan2(std::sqrt(aux), std::sqrt(1.0 - aux));
+    }
+
+    double scale;
+    uint32_t n = 0;
+    std::vector<Pending> pending;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<W> weights;
+    std::vector<float> lon, lat;
+};
+
+#endif //FEUP_DA_PROJ2_COMPACTGRAPH_H
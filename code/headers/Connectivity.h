@@ -0,0 +1,68 @@
+#ifndef FEUP_DA_PROJ2_CONNECTIVITY_H
+#define FEUP_DA_PROJ2_CONNECTIVITY_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+class Graph;
+
+/**
+ * Structure of the edges of a graph that rules out a Hamiltonian cycle over them: more than one connected component,
+ * vertices with fewer than two edges, bridges and cut vertices (a Hamiltonian cycle has none of these). The checks
+ * are necessary conditions only, so a graph that passes them may still have no tour.
+ */
+class Connectivity {
+public:
+    /**
+     * Computes the components with a union-find linked by several threads over the edges, then the bridges and cut
+     * vertices with one iterative depth-first search. \n
+     * Complexity: O(V² / T + V + E) V-> number of vertices; E-> number of edges; T-> number of threads
+     * @param graph The graph, with vertex ids 0 to V-1
+     * @param threads Number of threads (0 for one per hardware thread)
+     */
+    Connectivity(Graph &graph, unsigned threads);
+
+    int components() const { return componentCount; }
+
+    /**
+     * @return The vertices with fewer than two edges
+     */
+    const std::vector<int> &leaves() const { return lowDegree; }
+
+    const std::vector<std::pair<int, int>> &bridges() const { return bridgeEdges; }
+
+    const std::vector<int> &cutVertices() const { return cuts; }
+
+    /**
+     * @return True if there is an edge between every pair of vertices
+     */
+    bool complete() const { return isComplete; }
+
+    /**
+     * @return False if the edges cannot hold a Hamiltonian cycle
+     */
+    bool hamiltonianPossible() const { return reason().empty(); }
+
+    /**
+     * @return Why the edges cannot hold a Hamiltonian cycle, or an empty string if they might
+     */
+    std::string reason() const;
+
+    /**
+     * @return The bytes held by the lists of leaves, bridges and cut vertices
+     */
+    size_t memoryBytes() const {
+        return (lowDegree.capacity() + cuts.capacity()) * sizeof(int) + bridgeEdges.capacity() * sizeof(bridgeEdges[0]);
+    }
+
+private:
+    int vertices = 0;
+    int componentCount = 0;
+    bool isComplete = false;
+    std::vector<int> lowDegree;
+    std::vector<std::pair<int, int>> bridgeEdges;
+    std::vector<int> cuts;
+};
+
+#endif //FEUP_DA_PROJ2_CONNECTIVITY_H
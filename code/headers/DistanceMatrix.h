@@ -0,0 +1,100 @@
+#ifndef FEUP_DA_PROJ2_DISTANCEMATRIX_H
+#define FEUP_DA_PROJ2_DISTANCEMATRIX_H
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * Allocator that leaves new elements uninitialized, so that the pages of a large array are only placed in memory
+ * (on the NUMA node of the thread) when first written.
+ */
+template <class T>
+struct UninitializedAllocator : std::allocator<T> {
+    template <class U>
+    struct rebind { typedef UninitializedAllocator<U> other; };
+
+    UninitializedAllocator() = default;
+
+    template <class U>
+    UninitializedAllocator(const UninitializedAllocator<U>&) {}
+
+    template <class U>
+    void construct(U *p) { ::new((void*) p) U; }
+
+    template <class U, class... Args>
+    void construct(U *p, Args&&... args) { ::new((void*) p) U(std::forward<Args>(args)...); }
+};
+
+/**
+ * Dense n x n matrix of distances between vertices, stored row by row so that the distances from one vertex are
+ * contiguous. Pairs without a known distance hold infinity, so any move that needs them is never an improvement.
+ */
+class DistanceMatrix {
+public:
+    DistanceMatrix();
+
+    /**
+     * Creates a matrix with every distance unknown except the diagonal. \n
+     * Complexity: O(n²)
+     * @param n Number of vertices
+     */
+    DistanceMatrix(int n);
+
+    /**
+     * Creates a matrix with every distance unknown except the diagonal, each worker of the pool writing first to its
+     * own block of rows (see rowBlock), so that those rows are placed on the worker's NUMA node. \n
+     * Complexity: O(n² / T) T-> number of workers
+     * @param n Number of vertices
+     * @param pool The workers that will use the rows
+     */
+    DistanceMatrix(int n, ThreadPool &pool);
+
+    /**
+     * Splits the rows of an n x n matrix in contiguous blocks, one per part.
+     * @param begin Set to the first row of the part
+     * @param end Set to one past the last row of the part
+     */
+    static void rowBlock(int n, unsigned part, unsigned parts, int &begin, int &end);
+
+    /**
+     * Makes this an n x n matrix with every distance unknown except the diagonal, reusing the memory already held. \n
+     * Complexity: O(n²)
+     * @param n Number of vertices
+     */
+    void reset(int n);
+
+    int size() const { return n; }
+
+    double at(int u, int v) const { return data[(size_t) u * n + v]; }
+
+    void set(int u, int v, double d) { data[(size_t) u * n + v] = d; }
+
+    /**
+     * @return Pointer to the n distances from u
+     */
+    const double* row(int u) const { return data.data() + (size_t) u * n; }
+
+    /**
+     * @return True if the distance between u and v is known
+     */
+    bool known(int u, int v) const { return at(u, v) != unknown(); }
+
+    static double unknown() { return std::numeric_limits<double>::infinity(); }
+
+    /**
+     * @return The bytes held by the matrix
+     */
+    size_t memoryBytes() const { return data.capacity() * sizeof(double); }
+
+private:
+    int n = 0;
+    std::vector<double, UninitializedAllocator<double>> data;
+};
+
+#endif //FEUP_DA_PROJ2_DISTANCEMATRIX_H
@@ -0,0 +1,200 @@
+#ifndef FEUP_DA_PROJ2_EXACTSOLVER_H
+#define FEUP_DA_PROJ2_EXACTSOLVER_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "DistanceMatrix.h"
+
+/**
+ * Exact TSP by branch and bound for graphs of at most N vertices, with everything sized at compile time: the
+ * distances and the neighbours of each vertex (sorted by distance) in std::array tables, the visited set in a 32-bit
+ * mask and the partial and best tours in fixed arrays, all on the stack. A branch is cut when its cost plus a lower
+ * bound on the rest of the tour reaches the best tour, which starts as the nearest neighbour tour: first the cheapest
+ * edge into each vertex still to enter (vertex 0 included, for the way back), then a minimum spanning tree over them
+ * and the last vertex.
+ */
+template <int N>
+class ExactSolver {
+    static_assert(N >= 1 && N <= 32, "the visited set is a 32-bit mask");
+public:
+    /**
+     * Finds an optimal tour starting at vertex 0. \n
+     * Complexity: O(V!) in the worst case, usually far less; V-> number of vertices
+     * @param matrix Distances between the vertices, at most N of them (unknown pairs can't be used)
+     * @param tour Filled with the optimal tour
+     * @return The optimal cost, or -1.0 if there is no tour or the matrix has more than N vertices
+     */
+    static double solve(const DistanceMatrix &matrix, std::vector<int> &tour) {
+        tour.clear();
+        int n = matrix.size();
+        if (n == 0 || n > N) return -1.0;
+        if (n == 1) {
+            tour.push_back(0);
+            return 0.0;
+        }
+
+        State s{};
+        s.n = n;
+        double remaining = 0;
+        for (int u = 0; u < n; u++) {
+            s.minIn[u] = DistanceMatrix::unknown();
+            for (int v = 0; v < n; v++) s.dist[u * N + v] = matrix.at(u, v);
+        }
+        for (int u = 0; u < n; u++) {
+            int count = 0;
+            for (int v = 0; v < n; v++) {
+                if (v == u) continue;
+                s.order[u][count++] = (uint8_t) v;
+                s.minIn[v] = std::min(s.minIn[v], s.dist[u * N + v]);
+            }
+            const double* row = &s.dist[u * N];
+            std::sort(s.order[u].begin(), s.order[u].begin() + count,
+                      [row](uint8_t a, uint8_t b) { return row[a] < row[b]; });
+        }
+        for (int v = 0; v < n; v++) {
+            if (s.minIn[v] == DistanceMatrix::unknown()) return -1.0;
+            remaining += s.minIn[v];
+        }
+
+        s.best = nearestNeighbour(s);
+        s.path[0] = 0;
+        search(s, 1, 1u, 0.0, remaining);
+        if (s.best == DistanceMatrix::unknown()) return -1.0;
+
+        tour.assign(s.bestPath.begin(), s.bestPath.begin() + n);
+        return s.best;
+    }
+
+private:
+    struct State {
+        std::array<double, N * N> dist;
+        std::array<std::array<uint8_t, N>, N> order;     // the other vertices by increasing distance from each one
+        std::array<double, N> minIn;                    // cheapest edge into each vertex
+        std::array<uint8_t, N> path;
+        std::array<uint8_t, N> bestPath;
+        int n;
+        double best;
+    };
+
+    static double nearestNeighbour(State &s) {
+        uint32_t visited = 1u;
+        int u = 0;
+        double cost = 0;
+        s.bestPath[0] = 0;
+        for (int depth = 1; depth < s.n; depth++) {
+            int next = -1;
+            for (int i = 0; i < s.n - 1 && next == -1; i++) {
+                if (!(visited & (1u << s.order[u][i]))) next = s.order[u][i];
+            }
+            cost += s.dist[u * N + next];
+            visited |= 1u << next;
+            s.bestPath[depth] = (uint8_t) next;
+            u = next;
+        }
+        return cost + s.dist[u * N];
+    }
+
+    /**
+     * Extends the partial tour s.path[0 .. depth). remaining is the sum of the cheapest edges into the vertices
+     * still to enter, plus the one into vertex 0.
+     */
+    static void search(State &s, int depth, uint32_t visited, double cost, double remaining) {
+        int u = s.path[depth - 1];
+        if (depth == s.n) {
+            double total = cost + s.dist[u * N];
+            if (total < s.best) {
+                s.best = total;
+                s.bestPath = s.path;
+            }
+            return;
+        }
+
+        for (int i = 0; i < s.n - 1; i++) {
+            int v = s.order[u][i];
+            if (visited & (1u << v)) continue;
+            double next = cost + s.dist[u * N + v];
+            if (next >= s.best) break;      // the neighbours only get farther
+            double rest = remaining - s.minIn[v];
+            if (next + rest >= s.best) continue;
+            if (next + spanningTree(s, visited | (1u << v), v) >= s.best) continue;
+            s.path[depth] = (uint8_t) v;
+            search(s, depth + 1, visited | (1u << v), next, rest);
+        }
+    }
+
+    /**
+     * Weight of a minimum spanning tree over the vertices not visited, the last one (u) and vertex 0, which is at
+     * most the cost of any path from u through the rest back to 0. Prim over at most N vertices, on the stack.
+     */
+    static double spanningTree(const State &s, uint32_t visited, int u) {
+        std::array<uint8_t, N> left;
+        std::array<double, N> key;
+        int count = 0;
+        for (int v = 1; v < s.n; v++) {
+            if (!(visited & (1u << v))) {
+                left[count] = (uint8_t) v;
+                key[count++] = s.dist[u * N + v];
+            }
+        }
+        // vertex 0 joins the tree like any other vertex still to visit
+        left[count] = 0;
+        key[count++] = s.dist[u * N];
+
+        double weight = 0;
+        while (count > 0) {
+            int closest = 0;
+            for (int i = 1; i < count; i++) {
+                if (key[i] < key[closest]) closest = i;
+            }
+            weight += key[closest];
+            int w = left[closest];
+            left[closest] = left[--count];
+            key[closest] = key[count];
+            for (int i = 0; i < count; i++) key[i] = std::min(key[i], s.dist[w * N + left[i]]);
+        }
+        return weight;
+    }
+};
+
+/**
+ * Runs the smallest ExactSolver specialization that fits a graph: 8, 12, 16, 20 or 24 vertices.
+ */
+class ExactSolvers {
+public:
+    static const int maxSize = 24;
+
+    /**
+     * Finds an optimal tour starting at vertex 0 with the smallest specialization that fits. \n
+     * Complexity: O(V!) in the worst case; V-> number of vertices
+     * @param matrix Distances between the vertices (unknown pairs can't be used)
+     * @param tour Filled with the optimal tour
+     * @return The optimal cost, or -1.0 if there is no tour or the graph has more than maxSize vertices
+     */
+    static double solve(const DistanceMatrix &matrix, std::vector<int> &tour) {
+        return dispatch<8, 12, 16, 20, 24>(matrix, tour);
+    }
+
+    /**
+     * @return The size of the specialization used for n vertices, or 0 if none fits
+     */
+    static int specializationFor(int n) {
+        for (int size : {8, 12, 16, 20, 24}) {
+            if (n <= size) return size;
+        }
+        return 0;
+    }
+
+private:
+    template <int N, int... Larger>
+    static double dispatch(const DistanceMatrix &matrix, std::vector<int> &tour) {
+        if (matrix.size() <= N) return ExactSolver<N>::solve(matrix, tour);
+        if constexpr (sizeof...(Larger) > 0) return dispatch<Larger...>(matrix, tour);
+        tour.clear();
+        return -1.0;
+    }
+};
+
+#endif //FEUP_DA_PROJ2_EXACTSOLVER_H
@@ -0,0 +1,57 @@
+#ifndef FEUP_DA_PROJ2_GEOMETRY_H
+#define FEUP_DA_PROJ2_GEOMETRY_H
+
+#include <vector>
+
+#include "SpatialIndex.h"
+#include "VertexEdge.h"
+
+/**
+ * Coordinates of every vertex of a graph as separate arrays of radians, indexed by vertex id, with the cosine of each
+ * latitude computed once, plus a spatial index over them. The Haversine distance then needs two sines and an arc
+ * tangent instead of six trigonometric calls and two pointer chases, and gives exactly the same value as
+ * Graph::Haversine.
+ */
+class Geometry {
+public:
+    /**
+     * Builds the arrays and the index from points given by vertex id, before any vertex exists. \n
+     * Complexity: O(V) V-> number of points
+     * @param points Coordinates of each vertex, indexed by id
+     */
+    explicit Geometry(const std::vector<Coords> &points);
+
+    /**
+     * Builds the arrays and the index from the vertices of a graph, which must all have coordinates. \n
+     * Complexity: O(V) V-> number of vertices
+     */
+    explicit Geometry(const std::vector<Vertex*> &vertices);
+
+    /**
+     * Complexity: O(1)
+     * @return The Haversine distance between two vertices, in meters
+     */
+    double haversine(int u, int v) const;
+
+    /**
+     * @return The spatial index over the vertices (positions are vertex ids)
+     */
+    const SpatialIndex &index() const { return spatial; }
+
+    int size() const { return (int) latitude.size(); }
+
+    /**
+     * @return The bytes held by the arrays and the spatial index
+     */
+    size_t memoryBytes() const {
+        return (latitude.capacity() + longitude.capacity() + cosLatitude.capacity()) * sizeof(double)
+               + spatial.memoryBytes();
+    }
+
+private:
+    std::vector<double> latitude, longitude;    // radians
+    std::vector<double> cosLatitude;
+    SpatialIndex spatial;
+};
+
+#endif //FEUP_DA_PROJ2_GEOMETRY_H
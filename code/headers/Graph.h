@@ -1,10 +1,71 @@
 #ifndef FEUP_DA_PROJ2_GRAPH_H
 #define FEUP_DA_PROJ2_GRAPH_H
 
+#include <memory>
+
+#include "ThreadPool.h"
 #include "VertexEdge.h"
+#include "Connectivity.h"
+#include "DistanceMatrix.h"
+#include "Geometry.h"
+#include "Memory.h"
+#include "MetricClosure.h"
+#include "Metaheuristic.h"
+
+/**
+ * Construction heuristic used to build the starting tour of tspHeuristic.
+ */
+enum class TourSeed {
+    NearestNeighbour,
+    GreedyEdge,
+    SpaceFillingCurve
+};
+
+/**
+ * How tspHeuristic evaluates 2-opt moves: through calculateDistance on the graph, only towards the nearest candidates
+ * of each vertex (no V² memory, fit for big graphs), or every move on the cached distance matrix with the scalar loop
+ * or the AVX2 kernel. The two matrix kernels take the same moves and give the same tour.
+ */
+enum class MoveKernel {
+    GraphLookup,
+    MatrixScalar,
+    MatrixSimd
+};
+
+/**
+ * Order of the vertex ids after Graph::renumber: as read, reverse Cuthill-McKee over the edges (neighbours get close
+ * ids) or along a Hilbert curve over the coordinates (nearby points get close ids).
+ */
+enum class VertexOrder {
+    Original,
+    ReverseCuthillMcKee,
+    Hilbert
+};
+
+/**
+ * Options of tspHeuristic.
+ */
+struct HeuristicOptions {
+    TourSeed seed = TourSeed::NearestNeighbour;
+    MoveKernel kernel = MoveKernel::GraphLookup;
+    bool orOpt = false;     // follow 2-opt with Or-opt segment insertion (uses the distance matrix)
+};
 
 class Graph {
 public:
+    Graph() = default;
+
+    /**
+     * Deletes the vertices and edges of the graph. \n
+     * Complexity: O(V + E) V-> number of vertices; E-> number of edges
+     */
+    ~Graph();
+
+    // vertices and edges are owned through raw pointers, so a graph can be moved but not copied
+    Graph(const Graph&) = delete;
+    Graph& operator=(const Graph&) = delete;
+    Graph(Graph &&other) noexcept;
+    Graph& operator=(Graph &&other) noexcept;
 
     /**
      * Finds a vertex with a given id in the graph. \n
@@ -52,7 +113,8 @@ public:
 
     /**
      * Calculates the distance between the two vertices using the existing distance stored in the edge. If
-     * there is no edge, it uses the Haversine formula to calculate the distance. \n
+     * there is no edge, it uses the Haversine formula to calculate the distance, on the precomputed geometry when
+     * there is one. \n
      * Complexity: O(1)
      * @param v1 Pointer to the first vertex
      * @param v2 Pointer to the second vertex
@@ -82,6 +144,17 @@ public:
      */
     std::vector<Vertex *> mstPrim();
 
+    /**
+     * Creates the Minimum Spanning Tree (MST) of the graph using Prim's algorithm, with the weight of each edge (u, v)
+     * increased by penalty[u] + penalty[v] and without one of the vertices, as needed by the 1-tree lower bound. The
+     * dist of each vertex is set to the penalized weight of its path edge. \n
+     * Complexity: O((V+E)*log V) V-> number of vertices; E-> number of edges
+     * @param penalty Penalty of each vertex (empty for none)
+     * @param excluded Vertex left out of the tree (nullptr for none)
+     * @return Vector containing the vertices of the Minimum Spanning Tree (MST), in the order they were added
+     */
+    std::vector<Vertex *> mstPrim(const std::vector<double> &penalty, Vertex *excluded);
+
     /**
      * This function performs the backtracking algorithm to find the shortest path that visits all the vertices in
      * the graph. \n
@@ -110,14 +183,94 @@ public:
     */
     double nearestNeighbour(std::vector<Vertex *> &path);
 
+    /**
+    * Builds, for each vertex, a list of its k closest vertices. If every vertex has coordinates the lists come from a
+    * spatial grid, otherwise from the k shortest edges of each vertex. \n
+    * Complexity: O(V*k log k) with coordinates, O(V+E) otherwise
+    * @param k Number of candidates per vertex
+    * @return Vector, indexed by vertex id, with the ids of the candidates sorted by distance
+    */
+    std::vector<std::vector<int>> candidateLists(int k);
+
+    /**
+    * Builds a tour with the greedy edge matching: candidate edges are taken by increasing weight as long as no vertex
+    * gets degree 3 and no cycle is closed (checked with a union-find). The resulting fragments are then joined by
+    * nearest endpoint. \n
+    * Complexity: O(V*k log(V*k) + F²) V-> number of vertices; F-> number of fragments left by the matching
+    * @param path Reference to a vector of vertices that represents the tour found
+    * @param k Number of nearest candidates considered per vertex
+    * @return Double that represents the cost of the tour, or -1.0 if the fragments could not be joined
+    */
+    double greedyEdge(std::vector<Vertex *> &path, int k = 10);
+
+    /**
+    * Builds a tour by visiting the vertices in the order of a Hilbert space-filling curve over their coordinates. \n
+    * Complexity: O(V log V) V-> number of vertices
+    * @param path Reference to a vector of vertices that represents the tour found
+    * @return Double that represents the cost of the tour, or -1.0 if some vertex has no coordinates
+    */
+    double spaceFillingCurve(std::vector<Vertex *> &path);
+
+    /**
+    * Calculates the cost of a closed tour, using calculateDistance for each step. \n
+    * Complexity: O(V) V-> number of vertices
+    * @param path The tour, starting at vertex 0
+    * @return The cost of the tour
+    */
+    double tourCost(const std::vector<Vertex *> &path);
+
+    /**
+    * Checks if every vertex in the graph has coordinates. \n
+    * Complexity: O(V) V-> number of vertices
+    * @return True if all vertices have coordinates, false otherwise
+    */
+    bool hasCoords() const;
+
+    /**
+    * Sets the coordinates of the vertices from a buffer read before the vertices existed. Entries of ids that are not
+    * vertices are ignored. \n
+    * Complexity: O(C) C-> number of entries
+    * @param coords Pairs of vertex id and coordinates, in file order (later entries win)
+    */
+    void attachCoords(const std::vector<std::pair<int, Coords>> &coords);
+
+    /**
+    * Uses a precomputed geometry (coordinate arrays and spatial index) for the Haversine distances and the candidate
+    * lists. It is ignored unless it has one point per vertex and every vertex has coordinates; it must hold the same
+    * coordinates as the vertices. \n
+    * Complexity: O(V) V-> number of vertices
+    * @param built The geometry, built for example while the edges were still being read
+    * @return True if the geometry is used
+    */
+    bool setGeometry(std::shared_ptr<const Geometry> built);
+
+    /**
+    * Builds the geometry from the coordinates of the vertices, if every vertex has them. \n
+    * Complexity: O(V) V-> number of vertices
+    * @return True if the graph has a geometry afterwards
+    */
+    bool buildGeometry();
+
+    bool hasGeometry() const;
+
     /**
      * Finds the shortest path that visits all vertices in the graph using the backtracking algorithm. \n
      * Complexity: O(V!) V-> number of vertices
      * @param path Reference to a vector of vertices that represents the shortest path found so far
-     * @return Double that represents the cost of the best path
+     * @return Double that represents the cost of the best path, or -1.0 if the edges hold no tour
      */
     double tspBT(std::vector<Vertex*> &path);
 
+    /**
+     * Finds the shortest path that visits all vertices in the graph, over its edges like tspBT, with the smallest
+     * compile-time specialization of the exact solver (see ExactSolvers) that fits the graph. \n
+     * Complexity: O(V!) in the worst case, usually far less; V-> number of vertices
+     * @param path Reference to a vector of vertices that represents the shortest path found
+     * @return Double that represents the cost of the best path, or -1.0 if the edges hold no tour or the graph has
+     * more than ExactSolvers::maxSize vertices
+     */
+    double tspExact(std::vector<Vertex*> &path);
+
     /**
     * Finds the shortest path that visits all vertices in the graph using the Triangular Approximation Heuristic
     * algorithm. \n
@@ -128,12 +281,138 @@ public:
     double tspTriangular(std::vector<Vertex*> &path);
 
     /**
-    * Finds the shortest path that visits all vertices in the graph using our own heuristic. \n
-    * Complexity: Complexity: O(V⁴) V-> number of vertices
+    * Finds the shortest path that visits all vertices in the graph using our own heuristic: a construction heuristic
+    * followed by 2-opt over the candidate lists (see twoOptCandidates). \n
+    * Complexity: O(V*k) per improving move V-> number of vertices; k-> candidates per vertex
     * @param path Reference to a vector of vertices that represents the shortest path found
+    * @param seed Construction heuristic used to build the starting tour
     * @return Double that represents the cost of the best path
     */
-    double tspHeuristic(std::vector<Vertex *> &path);
+    double tspHeuristic(std::vector<Vertex *> &path, TourSeed seed = TourSeed::NearestNeighbour);
+
+    /**
+    * Finds the shortest path that visits all vertices in the graph using our own heuristic, with the construction
+    * heuristic, 2-opt move evaluation and Or-opt given in the options. \n
+    * Complexity: O(V*k) per improving move with GraphLookup, O(V²) per pass with the matrix kernels
+    * @param path Reference to a vector of vertices that represents the shortest path found
+    * @param options Seed, move kernel and whether to run Or-opt
+    * @return Double that represents the cost of the best path
+    */
+    double tspHeuristic(std::vector<Vertex *> &path, const HeuristicOptions &options);
+
+    /**
+    * Finds a tour with our heuristic (nearest neighbour + 2-opt) and keeps improving it with a metaheuristic for the
+    * time budget given in the options. \n
+    * Complexity: bounded by the time budget, after O(V²) to build the distance matrix
+    * @param path Reference to a vector of vertices that represents the shortest path found
+    * @param options Metaheuristic, time budget, seed and cooling schedule
+    * @param trace Filled with the best cost over time, starting with the cost given by tspHeuristic
+    * @return Double that represents the cost of the best path, or -1.0 if no tour was found
+    */
+    double tspMetaheuristic(std::vector<Vertex *> &path, const MetaheuristicOptions &options,
+                            std::vector<CostSample> &trace);
+
+    /**
+    * Returns the matrix with the distances (as given by calculateDistance) between every pair of vertices, building
+    * it on first use. The matrix is dropped when vertices or edges are added. \n
+    * Complexity: O(V²) V-> number of vertices the first time, O(1) afterwards
+    * @return The distance matrix of the graph
+    */
+    const DistanceMatrix &distanceMatrix();
+
+    /**
+    * Returns the distance matrix, building it on first use with the workers of a pool: each worker first touches
+    * and fills its own block of rows (see DistanceMatrix::rowBlock), so with pinned workers the rows are placed on
+    * the NUMA node of the worker that uses them. \n
+    * Complexity: O(V² / T) V-> number of vertices; T-> number of workers the first time, O(1) afterwards
+    * @param pool The workers that build the matrix
+    * @return The distance matrix of the graph
+    */
+    const DistanceMatrix &distanceMatrix(ThreadPool &pool);
+
+    /**
+    * Returns the distance matrix as a shared pointer, building it on first use. The matrix stays valid (and is
+    * never changed) even if the graph drops it or is destroyed, so it can be handed to other threads. \n
+    * Complexity: O(V²) V-> number of vertices the first time, O(1) afterwards
+    * @return The distance matrix of the graph
+    */
+    std::shared_ptr<const DistanceMatrix> sharedDistanceMatrix();
+
+    /**
+    * Returns the shortest-path distances between every pair of vertices over the edges of the graph, computing them
+    * on first use with the given number of threads. Like the distance matrix, the closure is dropped when vertices or
+    * edges are added and stays valid for whoever still holds it. \n
+    * Complexity: O(V³ / T) or O(V*(V+E)*log V / T) the first time (see MetricClosure), O(1) afterwards
+    * @param threads Number of threads (0 for one per hardware thread)
+    * @return The metric closure of the graph
+    */
+    std::shared_ptr<const MetricClosure> metricClosure(unsigned threads = 0);
+
+    /**
+    * Returns the connectivity of the edges (components, vertices with fewer than two edges, bridges and cut
+    * vertices), computing it on first use. It is dropped when vertices or edges are added. \n
+    * Complexity: O(V² / T + V + E) the first time (see Connectivity), O(1) afterwards
+    * @param threads Number of threads (0 for one per hardware thread)
+    * @return The connectivity of the graph
+    */
+    const Connectivity &connectivity(unsigned threads = 0);
+
+    /**
+    * Checks, from the cached connectivity, whether a tour may exist. Tours that may use any pair of vertices always
+    * exist when every vertex has coordinates, since calculateDistance then falls back to the Haversine distance. \n
+    * Complexity: O(V) V-> number of vertices once the connectivity is known
+    * @param edgesOnly True for tours over the edges only (like tspBT), false for tours using calculateDistance
+    * @return False if there can be no tour
+    */
+    bool tourPossible(bool edgesOnly);
+
+    /**
+    * Drops the cached distance matrix, metric closure, connectivity and geometry. \n
+    * Complexity: O(1)
+    */
+    void clearCaches();
+
+    /**
+    * Drops the cached distance matrix and metric closure, the caches that grow with V², to make room under the memory
+    * budget. They are built again when next needed. \n
+    * Complexity: O(1)
+    * @return The bytes they held
+    */
+    size_t evictDistances();
+
+    /**
+    * Counts the bytes owned by the graph: vertices, adjacency, edges, coordinates and caches. \n
+    * Complexity: O(V + E) V-> number of vertices; E-> number of edges
+    * @return The bytes by kind
+    */
+    GraphMemory memory() const;
+
+    /**
+    * @return The bytes distanceMatrix() would allocate, 0 if the matrix is already cached
+    */
+    size_t distanceMatrixBytes() const;
+
+    /**
+    * Renumbers the vertices so that vertices close in the graph (or in space) are close in vertexSet and in the
+    * adjacency vectors, which makes the algorithms touch less memory. Vertex 0 keeps id 0, since tours start there.
+    * Every algorithm then works with the new ids; originalId and internalId translate between the two. \n
+    * Complexity: O(V + E log d) V-> number of vertices; E-> number of edges; d-> maximum degree
+    * @param order The new order (Original undoes any previous renumbering)
+    * @return False if the order needs coordinates that some vertex doesn't have, in which case nothing changes
+    */
+    bool renumber(VertexOrder order);
+
+    /**
+    * @param id Id of a vertex in the graph
+    * @return The id the vertex had in the input files
+    */
+    int originalId(int id) const;
+
+    /**
+    * @param id Id of a vertex in the input files
+    * @return The id of the vertex in the graph, or -1 if there is none
+    */
+    int internalId(int id) const;
 
     /**
     * Returns the number of vertices in the graph.
@@ -151,6 +430,39 @@ public:
 
 protected:
     std::vector<Vertex*> vertexSet;
+    std::shared_ptr<DistanceMatrix> matrix;     // built by distanceMatrix()
+    std::shared_ptr<const MetricClosure> closure;   // built by metricClosure()
+    std::shared_ptr<const Connectivity> edgeConnectivity;   // built by connectivity()
+    std::shared_ptr<const Geometry> geometry;       // set by setGeometry() or buildGeometry()
+    std::vector<int> originalIds;                   // id in the input files of each vertex, empty if not renumbered
+    std::vector<int> internalIds;                   // inverse of originalIds
+
+    /**
+    * Computes the reverse Cuthill-McKee order: a breadth-first search from a vertex of minimum degree of each
+    * component, visiting neighbours by increasing degree, reversed.
+    */
+    std::vector<int> cuthillMcKeeOrder() const;
+
+    /**
+    * 2-opt restricted to the k nearest candidates of each vertex (see LocalSearch::twoOptCandidates), over
+    * calculateDistance. \n
+    * Complexity: O(V*k) per round of the queue plus O(V) per applied move V-> number of vertices
+    * @param path Tour to improve, starting at vertex 0
+    * @param cost Cost of the tour
+    * @param k Number of candidates per vertex
+    * @return The cost of the improved tour
+    */
+    double twoOptCandidates(std::vector<Vertex*> &path, double cost, int k);
+
+    /**
+    * Takes the vertices, edges and caches of another graph, which is left empty.
+    */
+    void takeFrom(Graph &other);
+
+    /**
+    * Deletes the vertices and edges and drops the caches.
+    */
+    void release();
 };
 
 #endif //FEUP_DA_PROJ2_GRAPH_H
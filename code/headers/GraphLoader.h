@@ -0,0 +1,72 @@
+#ifndef FEUP_DA_PROJ2_GRAPHLOADER_H
+#define FEUP_DA_PROJ2_GRAPHLOADER_H
+
+#include <future>
+#include <string>
+
+#include "Graph.h"
+
+/**
+ * Time taken by each stage of a GraphLoader, in milliseconds.
+ */
+struct LoadTimes {
+    double edgesMs = 0;     // reading the edges file into the graph
+    double nodesMs = 0;     // reading the nodes file and building the geometry, at the same time as the edges
+    double totalMs = 0;     // until the graph, its coordinates, geometry and connectivity were ready
+};
+
+struct LoadedGraph {
+    Graph graph;
+    LoadTimes times;
+};
+
+/**
+ * Handle of a graph being loaded in the background, so the caller can go on (for instance let the user pick an
+ * algorithm) while the files are read. The edges and nodes files are read at the same time: the coordinates go to a
+ * side buffer, from which the geometry (coordinate arrays, trigonometric terms and spatial index) is built while the
+ * edges are still being read, and are attached to the vertices once these exist. The connectivity of the graph is
+ * then computed before the graph is handed over.
+ */
+class GraphLoader {
+public:
+    /**
+     * A handle with no graph being loaded.
+     */
+    GraphLoader();
+
+    /**
+     * Starts loading a graph. \n
+     * Complexity: O(1), the loading itself is O(V + E) in the background
+     * @param edgesPath Path of the edges file
+     * @param nodesPath Path of the nodes file, or empty if the graph has no coordinates
+     */
+    GraphLoader(const std::string &edgesPath, const std::string &nodesPath);
+
+    /**
+     * @return True if a graph is being loaded and was not taken yet
+     */
+    bool pending() const;
+
+    /**
+     * @return True if the graph can be taken without waiting
+     */
+    bool ready() const;
+
+    /**
+     * Waits for the graph and hands it over; the handle then holds nothing. Errors of the loading (such as a
+     * malformed file) are thrown here.
+     * @return The graph and the time taken by each stage
+     */
+    LoadedGraph take();
+
+    /**
+     * Loads a graph in the calling thread, the two files still read at the same time. \n
+     * Complexity: O(V + E) V-> number of vertices; E-> number of edges
+     */
+    static LoadedGraph load(const std::string &edgesPath, const std::string &nodesPath);
+
+private:
+    std::future<LoadedGraph> result;
+};
+
+#endif //FEUP_DA_PROJ2_GRAPHLOADER_H
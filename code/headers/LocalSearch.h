@@ -0,0 +1,234 @@
+#ifndef FEUP_DA_PROJ2_LOCALSEARCH_H
+#define FEUP_DA_PROJ2_LOCALSEARCH_H
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "DistanceMatrix.h"
+
+/**
+ * Non-negative extra costs of some edges on top of a DistanceMatrix, such as the penalties of guided local search:
+ * a weight times the number of times each edge was penalized. Only a few edges get any, so they are kept per vertex
+ * as pairs of neighbour and count instead of in a penalized copy of the matrix.
+ */
+class EdgePenalties {
+public:
+    /**
+     * @param n Number of vertices
+     */
+    explicit EdgePenalties(int n);
+
+    /**
+     * Sets the cost added by each penalty of an edge. \n
+     * Complexity: O(1)
+     */
+    void setWeight(double w);
+
+    /**
+     * @return The number of penalties of the edge (u, v)
+     * Complexity: O(p) p-> number of penalized edges of u
+     */
+    int count(int u, int v) const;
+
+    /**
+     * @return The extra cost of the edge (u, v)
+     * Complexity: O(p) p-> number of penalized edges of u
+     */
+    double extra(int u, int v) const { return weight * count(u, v); }
+
+    /**
+     * Penalizes the edge (u, v) once more, in both directions. \n
+     * Complexity: O(p) p-> number of penalized edges of u and v
+     */
+    void add(int u, int v);
+
+    /**
+     * Writes the extra cost of every penalized edge (u, x) to row[x], leaving the other entries as they are. \n
+     * Complexity: O(p) p-> number of penalized edges of u
+     */
+    void spread(int u, std::vector<double> &row) const;
+
+    /**
+     * Zeroes the entries of row written by spread(u, row). \n
+     * Complexity: O(p) p-> number of penalized edges of u
+     */
+    void clear(int u, std::vector<double> &row) const;
+
+private:
+    void increment(int u, int v);
+
+    double weight = 0;
+    std::vector<std::vector<std::pair<int, int>>> lists;    // per vertex: neighbour, number of penalties
+};
+
+/**
+ * Tour improvement moves over a DistanceMatrix. Tours are vectors of vertex ids that start at vertex 0, which is
+ * never moved, and costs are updated incrementally with the gain of each move.
+ */
+class LocalSearch {
+public:
+    /**
+     * Checks if the AVX2 move evaluation kernel can run on this machine. \n
+     * Complexity: O(1)
+     */
+    static bool simdAvailable();
+
+    /**
+     * Builds a tour from vertex 0 by always moving to the closest unvisited vertex, like Graph::nearestNeighbour
+     * but over the matrix (so it may also use distances that are not edges of the graph). \n
+     * Complexity: O(V²) V-> number of vertices
+     * @param matrix Distances between the vertices
+     * @param tour Filled with the tour found
+     * @return The cost of the tour, or -1.0 if it got stuck or cannot be closed
+     */
+    static double nearestNeighbour(const DistanceMatrix &matrix, std::vector<int> &tour);
+
+    /**
+     * Applies improving 2-opt moves until none is left, taking the moves in a fixed order: for each i, every j after
+     * it, applying a move as soon as it improves the tour. With simd set (and AVX2 available), the gains of four consecutive j are evaluated at once from the rows of tour[i] and tour[i+1];
+     * the moves, and so the resulting tour, are the same as with the scalar loop. \n
+     * Complexity: O(V²) per pass V-> number of vertices
+     * @param matrix Distances between the vertices
+     * @param tour Tour to improve
+     * @param cost Cost of the tour, updated with every move
+     * @param simd Whether to use the vectorized kernel
+     * @return True if any move was applied
+     */
+    static bool twoOpt(const DistanceMatrix &matrix, std::vector<int> &tour, double &cost, bool simd);
+
+    /**
+     * The moves of twoOpt, in the same order, over the distances of the matrix plus the extra costs of the
+     * penalties. The penalties of tour[i] and tour[i+1] are spread over two rows of V extra costs while their moves
+     * are tried, so the inner loop looks no penalty up. With simd set (and AVX2 available), four j are first checked
+     * on the distances alone, which can only be lower, and the penalties are only added for the ones that pass. \n
+     * Complexity: O(V²) per pass V-> number of vertices
+     * @param matrix Distances between the vertices
+     * @param penalties Extra costs of the edges
+     * @param tour Tour to improve
+     * @param simd Whether to use the vectorized kernel
+     * @return True if any move was applied
+     */
+    static bool twoOpt(const DistanceMatrix &matrix, const EdgePenalties &penalties, std::vector<int> &tour,
+                       bool simd);
+
+    /**
+     * Applies improving Or-opt moves until none is left: a segment of 1 to 3 consecutive vertices is moved,
+     * possibly reversed, to the position between two other consecutive vertices. \n
+     * Complexity: O(V²) per pass V-> number of vertices
+     * @param matrix Distances between the vertices
+     * @param tour Tour to improve
+     * @param cost Cost of the tour, updated with every move
+     * @return True if any move was applied
+     */
+    static bool orOpt(const DistanceMatrix &matrix, std::vector<int> &tour, double &cost);
+
+    /**
+     * Alternates 2-opt and Or-opt until neither improves the tour. \n
+     * Complexity: O(V²) per pass V-> number of vertices
+     * @return True if any move was applied
+     */
+    static bool twoOptOrOpt(const DistanceMatrix &matrix, std::vector<int> &tour, double &cost, bool simd);
+
+    /**
+     * Calculates the cost of a closed tour. \n
+     * Complexity: O(V) V-> number of vertices
+     */
+    static double tourCost(const DistanceMatrix &matrix, const std::vector<int> &tour);
+
+    /**
+     * 2-opt restricted to candidate lists: for each vertex a and its tour neighbour b, only moves adding an edge from
+     * a to one of its candidates c closer than b are tried, with don't-look bits so that only vertices next to a
+     * changed edge are looked at again. Segments are reversed on the shorter side, and the tour is rotated back to
+     * start at its first vertex. Templated on the vertex ids and the cost type so that Graph and every CompactGraph
+     * weight type run the same moves. \n
+     * Complexity: O(V*k) per round of the queue plus O(V) per applied move V-> number of vertices; k-> candidates
+     * @param tour Tour to improve, a permutation of 0..V-1
+     * @param candidates Candidates of each vertex, sorted by increasing distance
+     * @param distance Callable (Id u, Id v, Sum &d) -> bool, false when the distance between u and v is unknown
+     * @param cost Cost of the tour
+     * @return The cost of the improved tour
+     */
+    template <class Id, class Sum, class Distance>
+    static Sum twoOptCandidates(std::vector<Id> &tour, const std::vector<std::vector<Id>> &candidates,
+                                const Distance &distance, Sum cost);
+
+private:
+    static bool twoOptScalar(const DistanceMatrix &matrix, std::vector<int> &tour, double &cost);
+    static bool twoOptAvx2(const DistanceMatrix &matrix, std::vector<int> &tour, double &cost);
+};
+
+template <class Id, class Sum, class Distance>
+Sum LocalSearch::twoOptCandidates(std::vector<Id> &tour, const std::vector<std::vector<Id>> &candidates,
+                                  const Distance &distance, Sum cost) {
+    size_t n = tour.size();
+    if (n < 5) return cost;
+    // smallest gain taken, so that rounding errors of floating point costs cannot make it cycle
+    const Sum minGain = std::is_floating_point<Sum>::value ? Sum(1e-9) : Sum(0);
+
+    Id first = tour[0];
+    std::vector<size_t> pos(n);
+    for (size_t i = 0; i < n; i++) pos[tour[i]] = i;
+
+    // reverses the cyclic segment tour[from..to], or the rest of the tour when that is shorter (same cycle)
+    auto reverse = [&](size_t from, size_t to) {
+        size_t length = (to + n - from) % n + 1;
+        if (2 * length > n) {
+            std::swap(from, to);
+            from = (from + 1) % n;
+            to = (to + n - 1) % n;
+            length = n - length;
+        }
+        for (size_t s = 0; s < length / 2; s++) {
+            size_t a = (from + s) % n, b = (to + n - s) % n;
+            std::swap(tour[a], tour[b]);
+            pos[tour[a]] = a;
+            pos[tour[b]] = b;
+        }
+    };
+
+    std::vector<Id> queue(tour);
+    std::vector<bool> queued(n, true);
+    for (size_t head = 0; head < queue.size(); head++) {
+        Id a = queue[head];
+        queued[a] = false;
+        bool moved = false;
+
+        for (int direction = 0; direction < 2 && !moved; direction++) {
+            size_t i = pos[a];
+            Id b = tour[direction == 0 ? (i + 1) % n : (i + n - 1) % n];
+            Sum ab;
+            if (!distance(a, b, ab)) continue;
+
+            for (Id c : candidates[a]) {
+                Sum ac;
+                if (!distance(a, c, ac) || !(ac < ab)) break;
+                size_t j = pos[c];
+                Id e = tour[direction == 0 ? (j + 1) % n : (j + n - 1) % n];
+                Sum be, ce;
+                if (c == b || e == a || !distance(b, e, be) || !distance(c, e, ce)) continue;
+
+                Sum gain = ab + ce - ac - be;
+                if (!(gain > minGain)) continue;
+                // a b ... c e becomes a c ... b e (or the mirror image going backwards)
+                if (direction == 0) reverse((i + 1) % n, j);
+                else reverse(j, (i + n - 1) % n);
+                cost -= gain;
+                for (Id v : {a, b, c, e}) {
+                    if (!queued[v]) {
+                        queued[v] = true;
+                        queue.push_back(v);
+                    }
+                }
+                moved = true;
+                break;
+            }
+        }
+    }
+
+    std::rotate(tour.begin(), tour.begin() + pos[first], tour.end());
+    return cost;
+}
+
+#endif //FEUP_DA_PROJ2_LOCALSEARCH_H
@@ -0,0 +1,99 @@
+#ifndef FEUP_DA_PROJ2_LOWERBOUND_H
+#define FEUP_DA_PROJ2_LOWERBOUND_H
+
+#include <functional>
+#include <vector>
+
+#include "Graph.h"
+
+/**
+ * Held-Karp lower bound on the cost of any tour: the weight of a 1-tree (a spanning tree of every vertex but 0, plus
+ * the two cheapest edges of vertex 0) with the edge weights shifted by node penalties, improved by subgradient
+ * optimization of the penalties. The state is kept between calls, so the bound can be improved a budget at a time.
+ *
+ * When every vertex has coordinates (or the graph is complete) tours may use any pair of vertices, so each 1-tree
+ * comes from an O(V²) Prim over every pair: on the distance matrix for up to matrixLimit vertices (or if the graph
+ * has it cached), with the distances computed on the fly, in O(V) memory, up to denseLimit vertices, and not at all
+ * beyond. A 1-tree over candidate lists only would not be a lower bound, since its tree can be heavier than the
+ * minimum one. Otherwise tours only use existing edges and each 1-tree is built with Graph::mstPrim over the
+ * adjacency of the graph.
+ */
+class LowerBound {
+public:
+    /**
+     * How improve(Graph&) builds the 1-trees of a graph.
+     */
+    enum class Mode {
+        Sparse,     // Graph::mstPrim over the edges
+        Matrix,     // Prim over the distance matrix
+        OnTheFly,   // Prim over every pair, computing each distance when needed
+        TooLarge    // dense, with too many vertices for an O(V²) 1-tree per iteration
+    };
+
+    // largest dense graph bounded over a distance matrix built for it (32 MB)
+    static const int matrixLimit = 2048;
+
+    // largest dense graph bounded at all, computing the distances on the fly
+    static const int denseLimit = 10000;
+
+    /**
+     * Picks the way the 1-trees of the graph are built. \n
+     * Complexity: O(V + E) V-> number of vertices; E-> number of edges
+     */
+    static Mode mode(Graph &graph);
+    /**
+     * Runs subgradient iterations for a time budget, continuing from the penalties of previous calls. \n
+     * Complexity: O(V²) or O((V+E)*log V) per iteration, bounded by the time budget
+     * @param graph The graph, which must be the same in every call
+     * @param timeBudgetMs Time budget of this call in milliseconds
+     * @param upperBound Cost of a known tour, used to size the steps (0 if none)
+     * @return The best lower bound found so far, or -1.0 if the graph has no 1-tree (and so no tour) or its mode is
+     * TooLarge
+     */
+    double improve(Graph &graph, long timeBudgetMs, double upperBound);
+
+    /**
+     * Runs subgradient iterations over a distance matrix only, continuing from the penalties of previous calls.
+     * The matrix is only read, so several threads can bound the same matrix with their own LowerBound. \n
+     * Complexity: O(V²) per iteration, bounded by the time budget
+     * @param matrix The distance matrix, which must be the same in every call
+     * @param timeBudgetMs Time budget of this call in milliseconds
+     * @param upperBound Cost of a known tour, used to size the steps (0 if none)
+     * @return The best lower bound found so far, or -1.0 if the matrix has no 1-tree
+     */
+    double improve(const DistanceMatrix &matrix, long timeBudgetMs, double upperBound);
+
+    /**
+     * @return The best lower bound found so far (-1.0 if none)
+     */
+    double getBound() const;
+
+    /**
+     * @return True if the last 1-tree was a tour, which makes the bound the optimal cost
+     */
+    bool isOptimal() const;
+
+private:
+    /**
+     * Runs the subgradient iterations, building each 1-tree with the given function.
+     */
+    double run(int n, long timeBudgetMs, double upperBound, const std::function<double(std::vector<int>&)> &oneTree);
+
+    /**
+     * Builds the 1-tree for the current penalties, over every pair of vertices (distance(u, v) is infinity when
+     * unknown) or over the edges of the graph.
+     * @param degree Filled with the degree of each vertex in the 1-tree
+     * @return The penalized weight of the 1-tree, or -1.0 if there is none
+     */
+    template <class Distance>
+    double oneTreeDense(int n, const Distance &distance, std::vector<int> &degree);
+    double oneTreeSparse(Graph &graph, std::vector<int> &degree);
+
+    std::vector<double> penalty;
+    double best = -1.0;
+    double lambda = 2.0;            // step size factor, halved when the bound stalls
+    int sinceImprovement = 0;
+    bool optimal = false;
+};
+
+#endif //FEUP_DA_PROJ2_LOWERBOUND_H
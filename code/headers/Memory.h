@@ -0,0 +1,67 @@
+#ifndef FEUP_DA_PROJ2_MEMORY_H
+#define FEUP_DA_PROJ2_MEMORY_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Memory of the process as seen by the kernel.
+ */
+struct ProcessMemory {
+    size_t residentBytes = 0;   // VmRSS
+    size_t peakBytes = 0;       // VmHWM, the highest resident size so far
+};
+
+/**
+ * Bytes owned by a graph, by kind, without allocator overhead.
+ */
+struct GraphMemory {
+    size_t vertices = 0;        // Vertex objects, the vertex set and the lists of MST children
+    size_t adjacency = 0;       // adjacency vectors, null slots included
+    size_t edges = 0;           // Edge objects
+    size_t coordinates = 0;     // Coords objects and the renumbering tables
+    size_t caches = 0;          // distance matrix, metric closure, connectivity and geometry
+
+    size_t total() const { return vertices + adjacency + edges + coordinates + caches; }
+};
+
+/**
+ * Process-wide memory budget. Large allocations (distance matrices, metric closures) are checked against it before
+ * they are made: callers first drop caches that can be rebuilt, then refuse the request if it still doesn't fit, so
+ * the process reports the problem instead of being killed when memory runs out.
+ */
+class MemoryBudget {
+public:
+    /**
+     * @param bytes The most the process may hold resident, 0 for no limit
+     */
+    static void setLimit(size_t bytes);
+
+    static size_t limit();
+
+    /**
+     * Reads the resident and peak sizes from /proc/self/status (zero where that is not available). \n
+     * Complexity: O(1), one small file read
+     */
+    static ProcessMemory process();
+
+    /**
+     * Reads the memory the system can still give without swapping (MemAvailable of /proc/meminfo). \n
+     * Complexity: O(1), one small file read
+     * @return The available bytes, 0 where that is not available
+     */
+    static size_t available();
+
+    /**
+     * @param bytes Size of an allocation about to be made
+     * @return True if there is no limit or the resident size plus the allocation stays within it
+     */
+    static bool fits(size_t bytes);
+
+    /**
+     * @return The size in the most readable unit, like "12.5 MB"
+     */
+    static std::string format(size_t bytes);
+};
+
+#endif //FEUP_DA_PROJ2_MEMORY_H
@@ -11,7 +11,11 @@ public:
     void run();
 private:
     Printer readSelectedFile();
+    void chooseVertexOrder();
+    void chooseOutput();
     bool isShippingGraph = false;
+    std::string outputPath;
+    OutputFormat outputFormat = OutputFormat::Plain;
     Printer printer;
 };
 #endif //FEUP_DA_PROJ2_MENU_H
@@ -0,0 +1,76 @@
+#ifndef FEUP_DA_PROJ2_METAHEURISTIC_H
+#define FEUP_DA_PROJ2_METAHEURISTIC_H
+
+#include <vector>
+
+#include "DistanceMatrix.h"
+
+enum class MetaheuristicKind {
+    SimulatedAnnealing,
+    GuidedLocalSearch,
+    IteratedLocalSearch
+};
+
+enum class CoolingSchedule {
+    Geometric,      // T = T0 * rate^k after k proposals, reheated to T0 on every restart
+    Linear          // T goes from T0 down to 0 over maxIterations proposals, or over the time budget without a limit
+};
+
+/**
+ * Options of a metaheuristic run. The run stops at the time budget or after maxIterations iterations (proposed
+ * moves for simulated annealing, local searches for the other two), whichever comes first. With an iteration limit
+ * the temperature follows the iterations too, so with a fixed seed and a limit that is reached first the result
+ * does not depend on the speed of the machine, whatever the cooling schedule.
+ */
+struct MetaheuristicOptions {
+    MetaheuristicKind kind = MetaheuristicKind::SimulatedAnnealing;
+    long timeBudgetMs = 10000;
+    long maxIterations = 0;                 // 0 means no limit
+    unsigned long seed = 1;
+    CoolingSchedule cooling = CoolingSchedule::Linear;
+    double initialTemperature = 0;          // 0 means estimated from the tour
+    double coolingRate = 0.99999;
+    double penaltyFactor = 0.3;             // lambda of guided local search
+};
+
+/**
+ * Best cost known after a given time of the run.
+ */
+struct CostSample {
+    long ms;
+    double cost;
+};
+
+/**
+ * Metaheuristics that keep improving a tour (as given by Graph::tspHeuristic) for a time budget:
+ * - simulated annealing over random 2-opt moves, with O(1) delta evaluation and restarts from the best tour;
+ * - guided local search, which penalizes the longest edges of each local optimum and runs 2-opt on the penalized
+ *   distances, adding the penalties (see EdgePenalties) on the fly so it needs no second matrix;
+ * - iterated local search, which kicks the best tour with random Or-opt segment moves and runs 2-opt + Or-opt.
+ * Tours start at vertex 0, which is never moved.
+ */
+class Metaheuristic {
+public:
+    /**
+     * Runs the metaheuristic chosen in the options. \n
+     * Complexity: bounded by the time budget
+     * @param matrix Distances between the vertices
+     * @param tour Starting tour, replaced by the best tour found
+     * @param cost Cost of the starting tour
+     * @param options Kind, budget, seed and schedule
+     * @param trace Filled with the best cost every time it improves
+     * @return The cost of the best tour found
+     */
+    static double run(const DistanceMatrix &matrix, std::vector<int> &tour, double cost,
+                      const MetaheuristicOptions &options, std::vector<CostSample> &trace);
+
+private:
+    static double simulatedAnnealing(const DistanceMatrix &matrix, std::vector<int> &tour, double cost,
+                                     const MetaheuristicOptions &options, std::vector<CostSample> &trace);
+    static double guidedLocalSearch(const DistanceMatrix &matrix, std::vector<int> &tour, double cost,
+                                    const MetaheuristicOptions &options, std::vector<CostSample> &trace);
+    static double iteratedLocalSearch(const DistanceMatrix &matrix, std::vector<int> &tour, double cost,
+                                      const MetaheuristicOptions &options, std::vector<CostSample> &trace);
+};
+
+#endif //FEUP_DA_PROJ2_METAHEURISTIC_H
@@ -0,0 +1,67 @@
+#ifndef FEUP_DA_PROJ2_METRICCLOSURE_H
+#define FEUP_DA_PROJ2_METRICCLOSURE_H
+
+#include <vector>
+
+#include "DistanceMatrix.h"
+
+class Graph;
+
+/**
+ * Shortest-path distances between every pair of vertices of a graph (its metric closure), with the first hop of each
+ * shortest path so that a tour over the closure can be expanded back into a walk over real edges. Built with
+ * Floyd-Warshall for small graphs and with one Dijkstra per source otherwise, in both cases split across threads.
+ * Once built it is only read, so it can be shared between queries and threads.
+ */
+class MetricClosure {
+public:
+    // graphs up to this many vertices use Floyd-Warshall
+    static const int floydWarshallLimit = 200;
+
+    /**
+     * Computes the all-pairs shortest paths over the edges of a graph (coordinates are not used). \n
+     * Complexity: O(V³ / T) with Floyd-Warshall, O(V*(V+E)*log V / T) with Dijkstra; T-> number of threads
+     * @param graph The graph, with vertex ids 0 to V-1
+     * @param threads Number of threads (0 for one per hardware thread)
+     */
+    MetricClosure(Graph &graph, unsigned threads);
+
+    int size() const { return distances.size(); }
+
+    /**
+     * @return The shortest-path distances, unknown (infinity) between vertices in different components
+     */
+    const DistanceMatrix &matrix() const { return distances; }
+
+    /**
+     * Expands a closed tour over the closure into the walk over real edges it stands for. \n
+     * Complexity: O(L) L-> number of edges of the walk
+     * @param tour Vertex ids of the tour, without repeating the first one at the end
+     * @return The walk, starting and ending at the first vertex of the tour, or empty if some stop is unreachable
+     */
+    std::vector<int> expand(const std::vector<int> &tour) const;
+
+    /**
+     * Fills an empty graph with the same vertices (and coordinates) as the source, and an edge between every pair
+     * of connected vertices weighing their shortest-path distance, so that every TSP algorithm can run on it. \n
+     * Complexity: O(V²) V-> number of vertices
+     * @param source The graph the closure was built from
+     * @param out The graph to fill
+     */
+    void toGraph(const Graph &source, Graph &out) const;
+
+    /**
+     * @return The bytes held by the distances and the first hops
+     */
+    size_t memoryBytes() const;
+
+private:
+    void floydWarshall(unsigned threads);
+    void dijkstra(const std::vector<int> &offsets, const std::vector<int> &targets,
+                  const std::vector<double> &weights, unsigned threads);
+
+    DistanceMatrix distances;
+    std::vector<int> firstHop;      // firstHop[u * V + v]: vertex after u on a shortest path to v (-1 if none)
+};
+
+#endif //FEUP_DA_PROJ2_METRICCLOSURE_H
@@ -0,0 +1,78 @@
+#ifndef FEUP_DA_PROJ2_NUMA_H
+#define FEUP_DA_PROJ2_NUMA_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "DistanceMatrix.h"
+
+class ThreadPool;
+
+/**
+ * A NUMA node and the CPUs of it this process may run on.
+ */
+struct NumaNode {
+    int id;
+    std::vector<int> cpus;
+};
+
+/**
+ * NUMA layout of the machine, read from /sys/devices/system/node (a single node with every allowed CPU when that is
+ * not available), restricted to the CPUs in the affinity mask of the process.
+ */
+class Topology {
+public:
+    /**
+     * @return The nodes with at least one allowed CPU, read once
+     */
+    static const std::vector<NumaNode> &nodes();
+
+    /**
+     * @return The node of a CPU, or 0 if it is unknown
+     */
+    static int nodeOfCpu(int cpu);
+
+    /**
+     * @return The CPU the calling thread is running on, or -1 if it is unknown
+     */
+    static int currentCpu();
+
+    /**
+     * Parses a kernel cpu list such as "0-3,8,10-11".
+     */
+    static std::vector<int> parseCpuList(const std::string &list);
+};
+
+/**
+ * One copy of a distance matrix per NUMA node that runs workers of a pool, each copied by a worker of its node so
+ * that its pages are placed there (first touch). Every node gets its own copy, the one of the original rows included,
+ * since a matrix filled by several nodes is spread over them. Solvers read the replica of the node they run on; with
+ * a single node (or no pinned worker) there is only the original matrix.
+ */
+class MatrixReplicas {
+public:
+    /**
+     * Makes the replicas. \n
+     * Complexity: O(K * V²) K-> number of nodes with workers; V-> number of vertices
+     * @param matrix The matrix to replicate, only kept when no copy is made
+     * @param pool Pool whose workers make the replicas, pinned like the ones that read them
+     * @param replicate False to keep only the original matrix
+     */
+    MatrixReplicas(std::shared_ptr<const DistanceMatrix> matrix, ThreadPool &pool, bool replicate);
+
+    /**
+     * @return The replica of the node the calling thread runs on
+     */
+    std::shared_ptr<const DistanceMatrix> local() const;
+
+    int size() const { return replicas.front()->size(); }
+
+    size_t count() const { return replicas.size(); }
+
+private:
+    std::vector<std::shared_ptr<const DistanceMatrix>> replicas;
+    std::vector<int> replicaOfNode;     // indexed by node id, -1 for nodes without a replica
+};
+
+#endif //FEUP_DA_PROJ2_NUMA_H
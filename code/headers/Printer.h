@@ -1,24 +1,74 @@
 #ifndef FEUP_DA_PROJ2_PRINTER_H
 #define FEUP_DA_PROJ2_PRINTER_H
 
+#include "BatchSolver.h"
 #include "Graph.h"
+#include "GraphLoader.h"
+#include "LowerBound.h"
 #include "Reader.h"
+#include "ResultWriter.h"
 
 #include <fstream>
+#include <memory>
 
 class Printer {
 public:
+    // largest graph whose shortest-path graph (V² distances and Edge objects) is built when no memory budget is set
+    static const int closureVertexLimit = 2000;
+
     Printer();
+
+    /**
+     * Starts loading a graph in the background (see GraphLoader); the nodes file next to it is read too for the real
+     * graphs. Every method that needs the graph waits for it.
+     */
     Printer(const std::string& edgesPath);
+    Printer(const std::string& edgesPath, const std::string& nodesPath);
+
+    /**
+     * @return True while the graph is still being loaded
+     */
+    bool isLoading() const;
+
+    /**
+     * Makes the TSP algorithms run on the metric closure of the graph (shortest-path distances between every pair of
+     * vertices) and print each tour expanded into the real edges it takes, or go back to the graph itself. Without
+     * a memory budget, graphs of more than closureVertexLimit vertices are refused. \n
+     * Complexity: see Graph::metricClosure, plus O(V²) to build the complete graph of the closure
+     * @param enabled True to use the closure
+     */
+    void setShortestPaths(bool enabled);
+
+    bool usesShortestPaths() const;
+
+    /**
+     * Renumbers the vertices of the graph for memory locality (see Graph::renumber). Paths are still printed with
+     * the ids of the input files. \n
+     * Complexity: O(V + E log d) V-> number of vertices; E-> number of edges; d-> maximum degree
+     * @param order The new order of the vertices
+     * @return False if the order needs coordinates the graph doesn't have
+     */
+    bool renumber(VertexOrder order);
+
+    /**
+     * Sets where paths and graph dumps are written, and in which format. Costs and times still go to stdout. \n
+     * Complexity: O(1)
+     * @param path Path of the file (appended to until the output changes), or empty for stdout
+     * @param format Format of the paths and dumps
+     */
+    void setOutput(const std::string& path, OutputFormat format);
 
     /**
-     * This function prints the content of the current graph.
+     * This function prints the content of the current graph (its nodes and edges, in the output format), the time
+     * taken to write it and the memory it owns.
      * Complexity: O(V+E) V-> number of vertices; E-> number of edges
      */
     void printContent();
 
     /**
-     * Prints the cost and path of a graph using a brute force approach of the TSP, as well as it's execution time. \n
+     * Prints the cost and path of a graph using a brute force approach of the TSP, as well as it's execution time.
+     * Graphs of up to ExactSolvers::maxSize vertices use the exact solver specialized for their size, the others the
+     * backtracking. \n
      * Complexity: O(V!) V-> number of vertices
      */
     void printCostAndPath();
@@ -33,10 +83,124 @@ public:
      /**
       * Prints the cost and path of our heuristic algorithm, as well as it's execution time. \n
       * Complexity: Complexity: O(V⁴) V-> number of vertices
+      * @param options Construction heuristic, move kernel and local search used
       */
-    void printCostAndPathHeuristic();
+    void printCostAndPathHeuristic(const HeuristicOptions& options);
+
+    /**
+     * Prints the cost and path found by a metaheuristic, as well as it's execution time and the best cost over time,
+     * starting from the cost of our heuristic. \n
+     * Complexity: bounded by the time budget of the options
+     * @param options Metaheuristic, time budget, seed and cooling schedule
+     */
+    void printCostAndPathMetaheuristic(const MetaheuristicOptions& options);
+
+    /**
+     * Compares the graph with its compact versions (float and fixed-point weights, 32-bit ids): memory per edge,
+     * plus cost and execution time of the MST and of our heuristic in each storage mode. \n
+     * Complexity: O(V⁴ log d) V-> number of vertices; d-> maximum degree
+     */
+    void printCompactStorage();
+
+    /**
+     * Reads a graph straight into compact storage (float weights, see Reader::readEdges), without building the full
+     * Graph, and prints its size, the memory it takes and the MST and heuristic costs as printCompactStorage does.
+     * This is the only way to solve graphs whose full version does not fit in memory. \n
+     * Complexity: O(V*k log d) per improving move of the heuristic, plus O(E log E) to read the graph
+     * @param edgesPath Path of the edges file
+     * @param nodesPath Path of the nodes file, or empty if the graph has no coordinates
+     */
+    static void printCompactFile(const std::string& edgesPath, const std::string& nodesPath);
+
+    /**
+     * Solves every sub-problem of a subsets file (see Reader::readSubsets) on the current graph in parallel and prints
+     * the number of instances solved per second, the total cost and the first few tours. \n
+     * Complexity: O(S * 2^k * k²) S-> number of subsets; k-> size of a subset, for subsets up to the exact threshold
+     * @param subsetsPath Path of the subsets file
+     * @param options Threshold for the exact solver, threads and chunk size
+     */
+    void printBatch(const std::string& subsetsPath, const BatchOptions& options);
 private:
+    /**
+     * Waits for the graph being loaded, if any, takes it and prints how long the loading took.
+     */
+    void waitForGraph();
+
+    /**
+     * Rejects, from the cached connectivity of the graph, a request that can have no tour, printing why. If the
+     * graph is connected but its edges hold no tour, switches to shortest-path distances instead. \n
+     * Complexity: O(V) once the connectivity is known
+     * @param edgesOnly True for algorithms that only follow edges (backtracking)
+     * @return False if the request is rejected
+     */
+    bool precheck(bool edgesOnly);
+
+    /**
+     * Checks an allocation against the memory budget, dropping the cached distances of the graphs if it doesn't fit,
+     * and prints why it is refused if it still doesn't. \n
+     * Complexity: O(1)
+     * @param bytes Size of the allocation
+     * @param what What the allocation is for, for the message
+     * @return True if the allocation may go ahead
+     */
+    bool admit(size_t bytes, const std::string& what);
+
+    /**
+     * Prints the current and peak resident memory of the process, and the budget if there is one.
+     */
+    static void printMemory();
+
+    /**
+     * @return The graph the TSP algorithms run on: the closure graph if shortest paths are enabled, the graph otherwise
+     */
+    Graph& active();
+
+    /**
+     * Prints a tour found on the closure graph as the walk over real edges it stands for (nothing if the closure is
+     * not in use). \n
+     * Complexity: O(L) L-> number of edges of the walk
+     * @param path The tour, starting at vertex 0
+     */
+    void printRoute(const std::vector<Vertex*>& path);
+
+    /**
+     * @return The writer of paths and dumps, opened on first use
+     */
+    ResultWriter& writer();
+
+    /**
+     * Writes a tour with the ids of the input files. \n
+     * Complexity: O(V) V-> number of vertices
+     * @param path The tour, starting at vertex 0
+     */
+    void writePath(const std::vector<Vertex*>& path);
+
+    /**
+     * Writes a list of ids to the output, labelled on stdout, and flushes it once. \n
+     * Complexity: O(n) n-> number of ids
+     */
+    void writeIds(const std::string& label, const std::vector<int>& ids, bool closed);
+
+    /**
+     * Improves the Held-Karp lower bound of the graph for another time slice and prints it with the optimality gap
+     * of a tour cost. Dense graphs too large for LowerBound are skipped. \n
+     * Complexity: bounded by boundBudgetMs
+     * @param cost Cost of the tour found by a heuristic
+     */
+    void printGap(double cost);
+
+    template <class W>
+    static void printCompactRow(const std::string& name, const CompactGraph<W>& compact);
+
+    GraphLoader loading;                                // graph still being loaded, if any
     Graph graph;
+    Graph closureGraph;                                 // complete graph over the closure, empty when not in use
+    std::shared_ptr<const MetricClosure> closure;
+    LowerBound lowerBound;
+    std::string outputPath;                             // empty for stdout
+    OutputFormat outputFormat = OutputFormat::Plain;
+    std::unique_ptr<ResultWriter> output;
+    long boundBudgetMs = 1000;
 };
 
 #endif //FEUP_DA_PROJ2_PRINTER_H
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <unordered_set>
 #include "Graph.h"
+#include "CompactGraph.h"
 
 class Reader {
 public:
@@ -23,6 +24,65 @@ public:
      */
     static void readNodes(std::ifstream &in, Graph& graph);
 
+    /**
+     * The method reads a nodes file into a buffer of coordinates, without a graph, so it can run while the edges file
+     * is still being read. Graph::attachCoords then gives them to the vertices.
+     * @param in nodes file ifstream
+     * @return Pairs of vertex id and coordinates, in the order of the file
+     */
+    static std::vector<std::pair<int, Coords>> readCoords(std::ifstream &in);
+
+    /**
+     * The method reads an edges file straight into a compact graph, without building a Graph first.
+     * CompactGraph::build must be called after the edges (and nodes) are read.
+     * @param in edges file ifstream
+     * @param graph
+     */
+    template <class W>
+    static void readEdges(std::ifstream &in, CompactGraph<W>& graph);
+
+    /**
+     * The method reads a nodes file and stores the coordinates in a compact graph.
+     * @param in nodes file ifstream
+     * @param graph
+     */
+    template <class W>
+    static void readNodes(std::ifstream &in, CompactGraph<W>& graph);
+
+    /**
+     * The method reads a file of sub-problems, one per line, each a list of vertex ids separated by commas or spaces.
+     * Empty lines and lines starting with '#' are skipped.
+     * @param in subsets file ifstream
+     * @return The subsets, in the order of the file
+     */
+    static std::vector<std::vector<int>> readSubsets(std::ifstream &in);
+
+private:
+    /**
+     * Reads the next record of a csv file with three fields. The first line is skipped unless it starts with '0',
+     * so files with and without a header are both accepted.
+     * @return False at the end of the file
+     */
+    static bool readRecord(std::ifstream &in, bool &isFirst, std::string &first, std::string &second,
+                           std::string &third);
 };
 
+template <class W>
+void Reader::readEdges(std::ifstream &in, CompactGraph<W>& graph) {
+    std::string src, dest, dist;
+    bool isFirst = true;
+    while (readRecord(in, isFirst, src, dest, dist)) {
+        graph.addEdge(std::stoul(src), std::stoul(dest), std::stod(dist));
+    }
+}
+
+template <class W>
+void Reader::readNodes(std::ifstream &in, CompactGraph<W>& graph) {
+    std::string id, longitude, latitude;
+    bool isFirst = true;
+    while (readRecord(in, isFirst, id, longitude, latitude)) {
+        graph.setCoords(std::stoul(id), std::stod(longitude), std::stod(latitude));
+    }
+}
+
 #endif //FEUP_DA_PROJ2_READER_H
@@ -0,0 +1,105 @@
+#ifndef FEUP_DA_PROJ2_RESULTWRITER_H
+#define FEUP_DA_PROJ2_RESULTWRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Format of the results written by ResultWriter:
+ * - Plain: tours as "0 -> 5 -> ... -> 0", nodes and edges as the NODE/SOURCE lines of Printer::printContent
+ * - Csv: tours as "position,id" rows, edges as "origem,destino,distancia" rows (readable by Reader::readEdges)
+ * - Binary: tours as an uint32 count followed by int32 ids, edges as (int32, int32, double) records, little endian
+ */
+enum class OutputFormat {
+    Plain,
+    Csv,
+    Binary
+};
+
+/**
+ * Writes tours and graph dumps to a file or to stdout through one large buffer, so that a tour of many thousands of
+ * vertices costs a handful of writes instead of a flush per line.
+ */
+class ResultWriter {
+public:
+    /**
+     * Opens the destination (truncating a file). \n
+     * Complexity: O(bufferBytes)
+     * @param path Path of the file, or empty for stdout
+     * @param format Format of the results
+     * @param bufferBytes Size of the buffer
+     */
+    ResultWriter(const std::string &path, OutputFormat format, size_t bufferBytes = 1 << 20);
+
+    /**
+     * Flushes the buffer and closes the file.
+     */
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    /**
+     * @return False if the file could not be opened, in which case nothing is written
+     */
+    bool isOpen() const { return out != nullptr; }
+
+    /**
+     * Writes a closed tour, repeating the first vertex at the end (except in the binary format). \n
+     * Complexity: O(V) V-> number of vertices of the tour
+     * @param ids Vertex ids of the tour
+     */
+    void writeTour(const std::vector<int> &ids);
+
+    /**
+     * Writes a walk as it is, without closing it. \n
+     * Complexity: O(L) L-> length of the walk
+     * @param ids Vertex ids of the walk
+     */
+    void writeWalk(const std::vector<int> &ids);
+
+    /**
+     * Writes the coordinates of a node (only in the plain format, the other ones hold edges only). \n
+     * Complexity: O(1)
+     */
+    void writeNode(int id, double latitude, double longitude);
+
+    /**
+     * Writes an edge. \n
+     * Complexity: O(1)
+     */
+    void writeEdge(int source, int dest, double distance);
+
+    /**
+     * Writes the buffer to the destination. \n
+     * Complexity: O(B) B-> bytes in the buffer
+     */
+    void flush();
+
+    /**
+     * @return The bytes written so far, including the ones still in the buffer
+     */
+    size_t bytesWritten() const { return written + used; }
+
+private:
+    void append(const char *data, size_t size);
+    void append(const std::string &text) { append(text.data(), text.size()); }
+    void appendInt(int64_t value);
+    void appendDouble(double value);
+    template <class T>
+    void appendRaw(T value) { append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+    void writeIds(const std::vector<int> &ids, bool closed);
+
+    FILE *out = nullptr;
+    bool ownsFile = false;
+    OutputFormat format;
+    std::vector<char> buffer;
+    size_t used = 0;
+    size_t written = 0;
+    bool csvHeader = false;     // whether the header of the current csv block was written
+};
+
+#endif //FEUP_DA_PROJ2_RESULTWRITER_H
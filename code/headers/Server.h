@@ -0,0 +1,108 @@
+#ifndef FEUP_DA_PROJ2_SERVER_H
+#define FEUP_DA_PROJ2_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Graph.h"
+#include "Numa.h"
+#include "ThreadPool.h"
+
+struct ServerOptions {
+    unsigned threads = 0;           // solver threads, 0 for one per hardware thread
+    size_t queueCapacity = 64;      // solve requests waiting for a thread before new ones are refused
+    std::string socketPath;         // listen on this Unix socket instead of stdin/stdout
+    Pinning pinning = Pinning::None;  // where the solver threads run
+    bool replicas = false;          // one copy of each distance matrix per NUMA node running solver threads
+};
+
+/**
+ * Long-running solver: keeps several graphs loaded under a name and answers requests given one per line, on
+ * stdin/stdout or on a local Unix socket (one connection per client). Solve requests are run on a bounded thread
+ * pool and answered when they finish, possibly out of order:
+ *
+ *   load <name> <edges.csv> [nodes.csv]          -> OK loaded <name> vertices=<V>
+ *   unload <name>                                -> OK unloaded <name>
+ *   list                                         -> OK <name>:<V> ...
+ *   solve <name> <algorithm> <budgetMs> [seed] [tour]
+ *                                                -> QUEUED <id>, later RESULT <id> cost=<c> ms=<t> [tour=0,4,...]
+ *   stats                                        -> STATS queue=<q> running=<r> completed=<c> rejected=<x> ...
+ *                                                   rss_mb=<m> peak_mb=<p> workers=<cpu>:<node>:<tasks>:<utilization>,...
+ *   quit                                         -> closes the connection (stops the server on stdin)
+ *   shutdown                                     -> stops the server
+ *
+ * Algorithms: nn, 2opt, oropt, sa, gls, ils (the last three use the budget) and bound (Held-Karp lower bound).
+ * Each graph's distance matrix is built when it is loaded by a helper pool pinned like the solver threads, each helper
+ * first touching (and so placing) its own rows, so a load does not wait for the queued solves. Solvers only read it,
+ * so requests on the same graph run concurrently without copies. With replicas on, each NUMA node running solver
+ * threads gets its own copy, made on that node, and solvers read the one of their node.
+ * A graph whose matrices would not fit in the memory budget (see MemoryBudget), or without a budget in the memory
+ * the system has available, is refused before they are built.
+ */
+class Server {
+public:
+    explicit Server(const ServerOptions &options);
+
+    /**
+     * Serves requests until the input ends or a shutdown request.
+     * @return The process exit code
+     */
+    int run();
+
+    /**
+     * Destination of the answers to the requests read from one input.
+     */
+    class Connection {
+    public:
+        virtual ~Connection() = default;
+        virtual void send(const std::string &line) = 0;
+    };
+
+private:
+    /**
+     * Handles one request line.
+     * @return False if the connection should be closed
+     */
+    bool handle(const std::string &line, const std::shared_ptr<Connection> &connection);
+
+    std::string load(const std::vector<std::string> &args);
+    std::string unload(const std::vector<std::string> &args);
+    std::string list();
+    std::string solve(const std::vector<std::string> &args, const std::shared_ptr<Connection> &connection);
+    std::string stats();
+
+    int serveStdin();
+    int serveSocket();
+    void serveClient(int fd);
+
+    void recordLatency(double ms);
+
+    ServerOptions options;
+    ThreadPool pool;
+
+    std::mutex loadMutex;
+    std::mutex registryMutex;
+    std::map<std::string, std::shared_ptr<const MatrixReplicas>> registry;
+
+    std::atomic<long> nextId{1};
+    std::atomic<long> completed{0};
+    std::atomic<long> rejected{0};
+    std::atomic<bool> stopping{false};
+
+    std::mutex latencyMutex;
+    std::vector<double> latencies;  // last latencies in ms, used as a ring buffer
+    size_t latencyNext = 0;
+    std::chrono::steady_clock::time_point started;
+
+    std::mutex clientsMutex;
+    std::set<int> clients;
+    int listenFd = -1;
+};
+
+#endif //FEUP_DA_PROJ2_SERVER_H
@@ -0,0 +1,82 @@
+#ifndef FEUP_DA_PROJ2_SPATIALINDEX_H
+#define FEUP_DA_PROJ2_SPATIALINDEX_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "VertexEdge.h"
+
+/**
+ * Uniform grid over the coordinates of a set of vertices. Longitudes are scaled by the cosine of the mean latitude,
+ * so that planar distances in the grid approximate distances on the ground well enough to rank neighbours.
+ * Every vertex in the set must have coordinates.
+ */
+class SpatialIndex {
+public:
+    SpatialIndex();
+
+    /**
+     * Builds the grid for the given vertices. Queries and results refer to positions in this vector, which are the
+     * vertex ids when the whole vertex set is given. \n
+     * Complexity: O(V) V-> number of vertices
+     * @param vertices Vertices to index
+     */
+    SpatialIndex(const std::vector<Vertex*> &vertices);
+
+    /**
+     * Builds the grid for the given points, which need no vertices yet (positions are indexes in this vector). \n
+     * Complexity: O(V) V-> number of points
+     * @param points Coordinates to index
+     */
+    SpatialIndex(const std::vector<Coords> &points);
+
+    /**
+     * Finds the k vertices closest to a given vertex, sorted by increasing distance. \n
+     * Complexity: O(k log k) expected for evenly spread points
+     * @param pos The position of the query vertex
+     * @param k Number of neighbours wanted
+     * @return The positions of the k nearest vertices (fewer if the set is smaller)
+     */
+    std::vector<int> nearest(int pos, int k) const;
+
+    /**
+     * Orders the vertices along a Hilbert space-filling curve over their coordinates. \n
+     * Complexity: O(V log V) V-> number of vertices
+     * @param vertices Vertices to order
+     * @return The positions of the vertices in curve order
+     */
+    static std::vector<int> hilbertOrder(const std::vector<Vertex*> &vertices);
+
+    /**
+     * Orders points, which need no vertices yet, along a Hilbert space-filling curve. \n
+     * Complexity: O(V log V) V-> number of points
+     * @param points Coordinates to order
+     * @return The positions of the points in curve order
+     */
+    static std::vector<int> hilbertOrder(const std::vector<Coords> &points);
+
+    /**
+     * @return The bytes held by the projected points and the cells
+     */
+    size_t memoryBytes() const {
+        return (xs.capacity() + ys.capacity()) * sizeof(double)
+               + (cellStart.capacity() + cellItems.capacity()) * sizeof(int);
+    }
+
+private:
+    /**
+     * Maps a point of a 2^order x 2^order grid to its distance along the Hilbert curve.
+     */
+    static uint64_t hilbertIndex(uint32_t x, uint32_t y, int order);
+
+    int cellOf(double x, double y, int &cx, int &cy) const;
+
+    std::vector<double> xs, ys;     // projected coordinates, indexed by position
+    std::vector<int> cellStart;     // items of cell c are cellItems[cellStart[c] .. cellStart[c+1]]
+    std::vector<int> cellItems;
+    double minX = 0, minY = 0, cellSize = 1;
+    int cols = 0, rows = 0;
+};
+
+#endif //FEUP_DA_PROJ2_SPATIALINDEX_H
@@ -0,0 +1,153 @@
+#ifndef FEUP_DA_PROJ2_THREADPOOL_H
+#define FEUP_DA_PROJ2_THREADPOOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Where the workers of a ThreadPool run: anywhere the scheduler wants, or each pinned to one CPU, filling one NUMA
+ * node before the next (Compact) or alternating between nodes (Spread).
+ */
+enum class Pinning {
+    None,
+    Compact,
+    Spread
+};
+
+/**
+ * Work done by one worker of a ThreadPool since it started.
+ */
+struct WorkerStats {
+    int cpu;                // CPU the worker is pinned to, -1 if not pinned
+    int node;               // NUMA node of that CPU, -1 if not pinned
+    size_t tasks;           // tasks run
+    double busyMs;          // time spent running them
+    double utilization;     // busyMs over the lifetime of the worker
+};
+
+/**
+ * Fixed set of worker threads taking tasks from a bounded queue. Workers can be pinned to CPUs, and tasks can be
+ * given to one worker in particular, which is how large arrays are first touched (and so placed in memory) by the
+ * workers that will use them.
+ */
+class ThreadPool {
+public:
+    /**
+     * Starts the workers, pinned as given by setDefaultPinning. \n
+     * Complexity: O(threads)
+     * @param threads Number of workers (0 for one per hardware thread)
+     * @param capacity Maximum number of queued tasks, not counting the running ones (0 for unbounded)
+     */
+    ThreadPool(unsigned threads, size_t capacity);
+
+    /**
+     * Starts the workers. \n
+     * Complexity: O(threads)
+     * @param threads Number of workers (0 for one per hardware thread)
+     * @param capacity Maximum number of queued tasks, not counting the running ones (0 for unbounded)
+     * @param pinning Where the workers run
+     */
+    ThreadPool(unsigned threads, size_t capacity, Pinning pinning);
+
+    /**
+     * Waits for the queued tasks to finish and stops the workers.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Sets the pinning of the pools created afterwards without one, such as the ones of the parallel loaders and
+     * solvers.
+     */
+    static void setDefaultPinning(Pinning pinning);
+
+    static Pinning defaultPinning();
+
+    /**
+     * Queues a task. \n
+     * Complexity: O(1)
+     * @param task The task to run
+     * @return False if the queue is full, in which case the task is not run
+     */
+    bool submit(std::function<void()> task);
+
+    /**
+     * Queues a task for one worker, ahead of the shared queue and regardless of its capacity. \n
+     * Complexity: O(1)
+     * @param worker Index of the worker, in [0, size())
+     * @param task The task to run
+     */
+    void submitTo(unsigned worker, std::function<void()> task);
+
+    /**
+     * Runs a task once on every worker, with the index of the worker, and waits for all of them. \n
+     * Complexity: O(threads) plus the tasks
+     * @param task The task to run
+     */
+    void forEachWorker(const std::function<void(unsigned)> &task);
+
+    /**
+     * Waits until the queue is empty and no task is running.
+     */
+    void wait();
+
+    /**
+     * @return The number of tasks waiting for a worker
+     */
+    size_t queueDepth();
+
+    /**
+     * @return The number of tasks being run
+     */
+    size_t running();
+
+    unsigned size() const;
+
+    /**
+     * @return The CPU a worker is pinned to, or -1 if it is not pinned
+     */
+    int cpuOf(unsigned worker) const;
+
+    /**
+     * @return The NUMA node of the CPU a worker is pinned to, or -1 if it is not pinned
+     */
+    int nodeOf(unsigned worker) const;
+
+    /**
+     * @return The work done by each worker so far
+     */
+    std::vector<WorkerStats> stats();
+
+private:
+    void work(unsigned index);
+
+    /**
+     * Pins a worker to its CPU, if any, and records whether that worked. Called by the constructor only.
+     */
+    void pin(unsigned index);
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::deque<std::function<void()>>> workerTasks;     // tasks given to one worker
+    size_t pendingWorkerTasks = 0;
+    std::mutex mutex;
+    std::condition_variable available;
+    std::condition_variable idle;
+    size_t capacity;
+    size_t active = 0;
+    bool stopping = false;
+
+    std::vector<int> cpus;              // CPU of each worker, -1 if not pinned
+    std::vector<size_t> taskCounts;
+    std::vector<std::chrono::steady_clock::duration> busy;
+    std::chrono::steady_clock::time_point started;
+};
+
+#endif //FEUP_DA_PROJ2_THREADPOOL_H
@@ -0,0 +1,76 @@
+#ifndef FEUP_DA_PROJ2_UFDS_H
+#define FEUP_DA_PROJ2_UFDS_H
+
+#include <atomic>
+#include <vector>
+
+/**
+ * Union-Find Disjoint Sets with path compression and union by rank.
+ */
+class UFDS {
+public:
+    /**
+     * Creates N singleton sets, one for each element in [0, N). \n
+     * Complexity: O(N)
+     * @param N Number of elements
+     */
+    UFDS(unsigned int N);
+
+    /**
+     * Finds the representative of the set that contains i. \n
+     * Complexity: O(α(N)) amortized
+     * @param i Element
+     * @return The representative of the set of i
+     */
+    unsigned int findSet(unsigned int i);
+
+    /**
+     * Checks if two elements belong to the same set. \n
+     * Complexity: O(α(N)) amortized
+     * @return True if i and j are in the same set, false otherwise
+     */
+    bool isSameSet(unsigned int i, unsigned int j);
+
+    /**
+     * Merges the sets that contain i and j. \n
+     * Complexity: O(α(N)) amortized
+     */
+    void linkSets(unsigned int i, unsigned int j);
+
+private:
+    std::vector<unsigned int> path;
+    std::vector<unsigned int> rank;
+};
+
+/**
+ * Union-Find Disjoint Sets that several threads can link at the same time, without locks: roots are linked with a
+ * compare-and-swap, always under the smaller root (so no cycles can form), and paths are halved while searching.
+ */
+class ConcurrentUFDS {
+public:
+    /**
+     * Creates N singleton sets, one for each element in [0, N). \n
+     * Complexity: O(N)
+     * @param N Number of elements
+     */
+    ConcurrentUFDS(unsigned int N);
+
+    /**
+     * Finds the representative of the set that contains i. \n
+     * Complexity: O(log N) amortized
+     * @param i Element
+     * @return The representative of the set of i
+     */
+    unsigned int findSet(unsigned int i);
+
+    /**
+     * Merges the sets that contain i and j. \n
+     * Complexity: O(log N) amortized
+     */
+    void linkSets(unsigned int i, unsigned int j);
+
+private:
+    std::vector<std::atomic<unsigned int>> path;
+};
+
+#endif //FEUP_DA_PROJ2_UFDS_H
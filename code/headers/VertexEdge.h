@@ -30,6 +30,7 @@ public:
     void setDist(double dist);
     void setPath(Edge *path);
     void setCoords(double longitude, double latitude);
+    void setId(int id);
 
     /*
      * Auxiliary function to add an outgoing edge to a vertex (this),
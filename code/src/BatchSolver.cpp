@@ -0,0 +1,156 @@
+#include "../headers/BatchSolver.h"
+#include "../headers/LocalSearch.h"
+#include "../headers/ThreadPool.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+const int BatchSolver::maxExact;
+const int BatchSolver::heldKarpLimit;
+const int BatchSolver::maxHeldKarp;
+
+namespace {
+    // memory of the dynamic programming and the sub-problem matrix, kept per thread so it is allocated once
+    thread_local std::vector<double> costArena;
+    thread_local std::vector<int8_t> parentArena;
+    thread_local DistanceMatrix localMatrix;
+
+    // pools of solve() without one, by number of threads, kept so that batches do not create threads every time
+    std::mutex poolsMutex;
+    std::map<unsigned, std::unique_ptr<ThreadPool>> pools;
+}
+
+std::vector<BatchResult> BatchSolver::solve(Graph &graph, const std::vector<std::vector<int>> &subsets,
+                                            const BatchOptions &options) {
+    ThreadPool* pool;
+    {
+        std::lock_guard<std::mutex> lock(poolsMutex);
+        std::unique_ptr<ThreadPool> &slot = pools[options.threads];
+        if (slot == nullptr) slot.reset(new ThreadPool(options.threads, 0));
+        pool = slot.get();
+    }
+    return solve(graph, subsets, options, *pool);
+}
+
+std::vector<BatchResult> BatchSolver::solve(Graph &graph, const std::vector<std::vector<int>> &subsets,
+                                            const BatchOptions &options, ThreadPool &pool) {
+    std::vector<BatchResult> results(subsets.size());
+    size_t chunk = (size_t) std::max(1, options.chunk);
+
+    // waits for its own chunks only, since the pool may be running other tasks too
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t pending = (subsets.size() + chunk - 1) / chunk;
+    for (size_t begin = 0; begin < subsets.size(); begin += chunk) {
+        size_t end = std::min(subsets.size(), begin + chunk);
+        auto task = [&graph, &subsets, &options, &results, &mutex, &done, &pending, begin, end]() {
+            for (size_t i = begin; i < end; i++) solveOne(graph, subsets[i], options, results[i]);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) done.notify_all();
+        };
+        // a bounded pool rejects tasks once its queue is full; those chunks run on the calling thread instead
+        if (!pool.submit(task)) task();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&pending]() { return pending == 0; });
+    return results;
+}
+
+void BatchSolver::solveOne(Graph &graph, const std::vector<int> &subset, const BatchOptions &options,
+                           BatchResult &result) {
+    int k = (int) subset.size();
+    std::vector<Vertex*> vertices(k);
+    for (int i = 0; i < k; i++) {
+        vertices[i] = subset[i] >= 0 ? graph.findVertex(subset[i]) : nullptr;
+        if (vertices[i] == nullptr) return;
+    }
+    if (k == 0) return;
+
+    DistanceMatrix &local = localMatrix;
+    local.reset(k);
+    for (int i = 0; i < k; i++) {
+        for (int j = 0; j < k; j++) {
+            if (i == j) continue;
+            double d = graph.calculateDistance(vertices[i], vertices[j]);
+            if (d != -1.0) local.set(i, j, d);
+        }
+    }
+
+    std::vector<int> tour;
+    double cost;
+    if (k <= std::min(options.exactThreshold, heldKarpLimit)) {
+        cost = heldKarp(local, tour);
+    } else if (k <= std::min(options.exactThreshold, maxExact)) {
+        cost = ExactSolvers::solve(local, tour);
+    } else {
+        cost = LocalSearch::nearestNeighbour(local, tour);
+        if (cost != -1.0) LocalSearch::twoOptOrOpt(local, tour, cost, true);
+    }
+    if (cost == -1.0) return;
+
+    result.cost = cost;
+    result.tour.resize(k);
+    for (int i = 0; i < k; i++) result.tour[i] = subset[tour[i]];
+}
+
+double BatchSolver::heldKarp(const DistanceMatrix &matrix, std::vector<int> &tour) {
+    int k = matrix.size();
+    tour.clear();
+    if (k == 0 || k > maxHeldKarp) return -1.0;
+    if (k == 1) {
+        tour.push_back(0);
+        return 0.0;
+    }
+
+    // cost[mask * m + j]: cheapest path from 0 through the vertices of mask (bit j is vertex j + 1) ending at j + 1
+    int m = k - 1;
+    size_t states = (size_t) 1 << m;
+    costArena.assign(states * m, DistanceMatrix::unknown());
+    parentArena.assign(states * m, -1);
+    double* cost = costArena.data();
+    int8_t* parents = parentArena.data();
+
+    for (int j = 0; j < m; j++) cost[((size_t) 1 << j) * m + j] = matrix.at(0, j + 1);
+    for (size_t mask = 1; mask < states; mask++) {
+        for (int j = 0; j < m; j++) {
+            double current = cost[mask * m + j];
+            if (!(mask & ((size_t) 1 << j)) || current == DistanceMatrix::unknown()) continue;
+            const double* row = matrix.row(j + 1);
+            for (int next = 0; next < m; next++) {
+                if (mask & ((size_t) 1 << next)) continue;
+                size_t state = (mask | ((size_t) 1 << next)) * m + next;
+                double candidate = current + row[next + 1];
+                if (candidate < cost[state]) {
+                    cost[state] = candidate;
+                    parents[state] = (int8_t) j;
+                }
+            }
+        }
+    }
+
+    size_t full = states - 1;
+    double best = DistanceMatrix::unknown();
+    int last = -1;
+    for (int j = 0; j < m; j++) {
+        double candidate = cost[full * m + j] + matrix.at(j + 1, 0);
+        if (candidate < best) {
+            best = candidate;
+            last = j;
+        }
+    }
+    if (last == -1) return -1.0;
+
+    tour.resize(k);
+    tour[0] = 0;
+    size_t mask = full;
+    for (int position = k - 1; position >= 1; position--) {
+        tour[position] = last + 1;
+        int previous = parents[mask * m + last];
+        mask &= ~((size_t) 1 << last);
+        last = previous;
+    }
+    return best;
+}
@@ -0,0 +1,105 @@
+#include "../headers/Connectivity.h"
+#include "../headers/Graph.h"
+#include "../headers/ThreadPool.h"
+#include "../headers/UFDS.h"
+#include <algorithm>
+
+Connectivity::Connectivity(Graph &graph, unsigned threads) {
+    std::vector<Vertex*> vertexSet = graph.getVertexSet();
+    int n = (int) vertexSet.size();
+    vertices = n;
+    if (n == 0) return;
+
+    // degrees and components, each thread over its own block of vertices
+    std::vector<int> degree(n, 0);
+    ConcurrentUFDS sets(n);
+    {
+        ThreadPool pool(threads, 0);
+        int block = std::max(64, n / (int) (4 * pool.size()));
+        for (int begin = 0; begin < n; begin += block) {
+            int end = std::min(n, begin + block);
+            pool.submit([&vertexSet, &degree, &sets, begin, end]() {
+                for (int u = begin; u < end; u++) {
+                    for (auto e : vertexSet[u]->adj) {
+                        if (e == nullptr) continue;
+                        int v = e->getDest()->getId();
+                        if (v == u) continue;
+                        degree[u]++;
+                        if (u < v) sets.linkSets(u, v);
+                    }
+                }
+            });
+        }
+        pool.wait();
+    }
+
+    isComplete = true;
+    for (int u = 0; u < n; u++) {
+        if (sets.findSet(u) == (unsigned) u) componentCount++;
+        if (degree[u] < 2) lowDegree.push_back(u);
+        if (degree[u] != n - 1) isComplete = false;
+    }
+    // a complete graph of 3 or more vertices has neither bridges nor cut vertices
+    if (isComplete || componentCount > 1) return;
+
+    // adjacency in compressed rows for the depth-first search
+    std::vector<int> offsets(n + 1, 0), targets;
+    for (int u = 0; u < n; u++) offsets[u + 1] = offsets[u] + degree[u];
+    targets.resize(offsets[n]);
+    for (int u = 0; u < n; u++) {
+        int at = offsets[u];
+        for (auto e : vertexSet[u]->adj) {
+            if (e != nullptr && e->getDest()->getId() != u) targets[at++] = e->getDest()->getId();
+        }
+    }
+
+    // iterative Tarjan: order[u] is the discovery time, low[u] the earliest vertex reachable from the subtree of u
+    std::vector<int> order(n, -1), low(n, 0), from(n, -1), next(n, 0);
+    std::vector<bool> isCut(n, false);
+    std::vector<int> stack;
+    int time = 0;
+    for (int root = 0; root < n; root++) {
+        if (order[root] != -1) continue;
+        int rootChildren = 0;
+        order[root] = low[root] = time++;
+        next[root] = offsets[root];
+        stack.push_back(root);
+
+        while (!stack.empty()) {
+            int u = stack.back();
+            if (next[u] < offsets[u + 1]) {
+                int v = targets[next[u]++];
+                if (order[v] == -1) {
+                    from[v] = u;
+                    order[v] = low[v] = time++;
+                    next[v] = offsets[v];
+                    stack.push_back(v);
+                    if (u == root) rootChildren++;
+                } else if (v != from[u]) {
+                    low[u] = std::min(low[u], order[v]);
+                }
+                continue;
+            }
+
+            stack.pop_back();
+            int up = from[u];
+            if (up == -1) continue;
+            low[up] = std::min(low[up], low[u]);
+            if (low[u] > order[up]) bridgeEdges.emplace_back(std::min(u, up), std::max(u, up));
+            if (up != root && low[u] >= order[up]) isCut[up] = true;
+        }
+        if (rootChildren > 1) isCut[root] = true;
+    }
+    for (int u = 0; u < n; u++) {
+        if (isCut[u]) cuts.push_back(u);
+    }
+}
+
+std::string Connectivity::reason() const {
+    if (vertices < 3) return "a tour needs at least 3 vertices";
+    if (componentCount > 1) return "the graph has " + std::to_string(componentCount) + " connected components";
+    if (!lowDegree.empty()) return std::to_string(lowDegree.size()) + " vertices have fewer than two edges";
+    if (!bridgeEdges.empty()) return "the graph has " + std::to_string(bridgeEdges.size()) + " bridges";
+    if (!cuts.empty()) return "the graph has " + std::to_string(cuts.size()) + " cut vertices";
+    return "";
+}
@@ -0,0 +1,33 @@
+#include "../headers/DistanceMatrix.h"
+#include "../headers/ThreadPool.h"
+#include <algorithm>
+
+DistanceMatrix::DistanceMatrix() = default;
+
+DistanceMatrix::DistanceMatrix(int n) {
+    reset(n);
+}
+
+void DistanceMatrix::reset(int n) {
+    this->n = n;
+    data.assign((size_t) n * n, unknown());
+    for (int i = 0; i < n; i++) set(i, i, 0.0);
+}
+
+DistanceMatrix::DistanceMatrix(int n, ThreadPool &pool): n(n) {
+    data.resize((size_t) n * n);
+    pool.forEachWorker([this, &pool](unsigned worker) {
+        int begin, end;
+        rowBlock(this->n, worker, pool.size(), begin, end);
+        for (int u = begin; u < end; u++) {
+            double* row = data.data() + (size_t) u * this->n;
+            std::fill(row, row + this->n, unknown());
+            row[u] = 0.0;
+        }
+    });
+}
+
+void DistanceMatrix::rowBlock(int n, unsigned part, unsigned parts, int &begin, int &end) {
+    begin = (int) ((long long) n * part / parts);
+    end = (int) ((long long) n * (part + 1) / parts);
+}
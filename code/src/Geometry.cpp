@@ -0,0 +1,33 @@
+#include "../headers/Geometry.h"
+#include <cmath>
+
+namespace {
+    std::vector<Coords> coordsOf(const std::vector<Vertex*> &vertices) {
+        std::vector<Coords> points;
+        points.reserve(vertices.size());
+        for (auto v : vertices) points.push_back(*v->getCoords());
+        return points;
+    }
+}
+
+Geometry::Geometry(const std::vector<Coords> &points): spatial(points) {
+    latitude.resize(points.size());
+    longitude.resize(points.size());
+    cosLatitude.resize(points.size());
+    // same expressions as Graph::Haversine, so the distances match it bit for bit
+    for (size_t i = 0; i < points.size(); i++) {
+        latitude[i] = (points[i].latitude * M_PI) / 180.0;
+        longitude[i] = (points[i].longitude * M_PI) / 180.0;
+        cosLatitude[i] = std::cos(latitude[i]);
+    }
+}
+
+Geometry::Geometry(const std::vector<Vertex*> &vertices): Geometry(coordsOf(vertices)) {}
+
+double Geometry::haversine(int u, int v) const {
+    double halfLat = std::sin((latitude[v] - latitude[u]) / 2.0);
+    double halfLon = std::sin((longitude[v] - longitude[u]) / 2.0);
+    double aux = halfLat * halfLat + cosLatitude[u] * cosLatitude[v] * halfLon * halfLon;
+    double c = 2.0 * std::atan2(std::sqrt(aux), std::sqrt(1.0 - aux));
+    return 6371000.0 * c;
+}
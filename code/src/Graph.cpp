@@ -1,14 +1,60 @@
 #include <iostream>
 #include "../headers/Graph.h"
+#include "../headers/ExactSolver.h"
+#include "../headers/LocalSearch.h"
+#include "../headers/SpatialIndex.h"
+#include "../headers/UFDS.h"
 #include <algorithm>
 #include <valarray>
 
+Graph::~Graph() {
+    release();
+}
+
+Graph::Graph(Graph &&other) noexcept {
+    takeFrom(other);
+}
+
+Graph& Graph::operator=(Graph &&other) noexcept {
+    if (this != &other) {
+        release();
+        takeFrom(other);
+    }
+    return *this;
+}
+
+void Graph::takeFrom(Graph &other) {
+    vertexSet = std::move(other.vertexSet);
+    matrix = std::move(other.matrix);
+    closure = std::move(other.closure);
+    edgeConnectivity = std::move(other.edgeConnectivity);
+    geometry = std::move(other.geometry);
+    originalIds = std::move(other.originalIds);
+    internalIds = std::move(other.internalIds);
+    other.vertexSet.clear();
+    other.originalIds.clear();
+    other.internalIds.clear();
+}
+
+void Graph::release() {
+    for (auto v : vertexSet) {
+        if (v == nullptr) continue;
+        for (auto e : v->adj) delete e;
+        delete v;
+    }
+    vertexSet.clear();
+    originalIds.clear();
+    internalIds.clear();
+    clearCaches();
+}
+
 Vertex* Graph::findVertex(const int &id) {
     if(id < vertexSet.size()) return vertexSet[id];
     else return nullptr;
 }
 
 Vertex* Graph::addVertex(const int &id) {
+    clearCaches();
     if (id >= vertexSet.size()) vertexSet.resize(id + 1, nullptr);
 
     if (vertexSet[id] == nullptr) vertexSet[id] = new Vertex(id);
@@ -18,6 +64,7 @@ Vertex* Graph::addVertex(const int &id) {
 bool Graph::addBidirectionalEdge(Vertex* v1, Vertex* v2, double w) {
     if (v1 == nullptr || v2 == nullptr)
         return false;
+    clearCaches();
     v1->addEdge(v2, w);
     v2->addEdge(v1, w);
     return true;
@@ -48,7 +95,8 @@ double Graph::Haversine(Vertex* v1, Vertex* v2) {
 
 double Graph::calculateDistance(Vertex *v1,Vertex *v2){
     double distance = Graph::dist(v1,v2);
-    if (distance == -1.0){
+    if (distance == -1.0 && geometry != nullptr) return geometry->haversine(v1->getId(), v2->getId());
+    if (distance == -1.0 && v1->getCoords() != nullptr && v2->getCoords() != nullptr){
         distance = Graph::Haversine(v1,v2);
     }
     return distance;
@@ -77,13 +125,23 @@ void Graph::dfs(Vertex* v, std::vector<Vertex*>& visited) {
 }
 
 std::vector<Vertex *> Graph::mstPrim() {
+    return mstPrim({}, nullptr);
+}
+
+std::vector<Vertex *> Graph::mstPrim(const std::vector<double> &penalty, Vertex *excluded) {
     MutablePriorityQueue<Vertex> q;
     std::vector<Vertex *> res;
+    Vertex* root = nullptr;
     for (auto v: vertexSet) {
+        v->setPath(nullptr);
+        if (v == excluded) {
+            v->setVisited(true);
+            continue;
+        }
         v->setVisited(false);
-        if (v == *vertexSet.begin()) {
+        if (root == nullptr) {
+            root = v;
             v->setDist(0);
-            v->setPath(nullptr);
         } else {
             v->setDist(INT_MAX);
         }
@@ -96,9 +154,11 @@ std::vector<Vertex *> Graph::mstPrim() {
         for (auto w: u->adj) {
             if (w == nullptr) continue;
             auto v = w->getDest();
-            if (!v->isVisited() && w->getDistance() < v->getDist()) {
+            double weight = w->getDistance();
+            if (!penalty.empty()) weight += penalty[u->getId()] + penalty[v->getId()];
+            if (!v->isVisited() && weight < v->getDist()) {
                 v->setPath(w);
-                v->setDist(w->getDistance());
+                v->setDist(weight);
                 q.decreaseKey(v);
             }
         }
@@ -133,12 +193,33 @@ void Graph::backtracking(std::vector<Vertex*> &path, std::vector<Vertex*> currPa
 
 
 double Graph::tspBT(std::vector<Vertex*> &path) {
+    path.clear();
+    if (!tourPossible(true)) return -1.0;
+
     std::vector<Vertex*> currPath(vertexSet.size(), nullptr);
     double bestCost = LONG_MAX;
     currPath[0] = vertexSet[0];
     backtracking(path, currPath, 0, bestCost, 1);
 
-    return bestCost;
+    return path.empty() ? -1.0 : bestCost;
+}
+
+double Graph::tspExact(std::vector<Vertex*> &path) {
+    path.clear();
+    int n = getNumVertex();
+    if (n > ExactSolvers::maxSize || !tourPossible(true)) return -1.0;
+
+    DistanceMatrix edges(n);
+    for (auto v : vertexSet) {
+        for (auto e : v->adj) {
+            if (e != nullptr) edges.set(v->getId(), e->getDest()->getId(), e->getDistance());
+        }
+    }
+
+    std::vector<int> tour;
+    double cost = ExactSolvers::solve(edges, tour);
+    for (int id : tour) path.push_back(vertexSet[id]);
+    return cost;
 }
 
 double Graph::calculateShipping(std::vector<Vertex*> &path){
@@ -220,32 +301,482 @@ double Graph::nearestNeighbour(std::vector<Vertex*> &path) {
 }
 
 
-double Graph::tspHeuristic(std::vector<Vertex*> &path) {
-    double cost = nearestNeighbour(path);
-
-    if(cost == -1.0) return -1.0;
+std::vector<std::vector<int>> Graph::candidateLists(int k) {
+    std::vector<std::vector<int>> candidates(vertexSet.size());
 
-    bool improved = true;
-    while (improved) {
-        improved = false;
+    if (geometry != nullptr) {
+        for (auto v : vertexSet) candidates[v->getId()] = geometry->index().nearest(v->getId(), k);
+        return candidates;
+    }
+    if (hasCoords()) {
+        SpatialIndex index(vertexSet);
+        for (auto v : vertexSet) candidates[v->getId()] = index.nearest(v->getId(), k);
+        return candidates;
+    }
 
-        for (int i = 0; i < path.size() - 2; i++) {
-            for (int j = i + 2; j < path.size() - 1; j++) {
-                double oldCost = calculateDistance(path[i], path[i + 1]) + calculateDistance(path[j], path[j + 1]);
-                double newCost = calculateDistance(path[i], path[j]) + calculateDistance(path[i + 1], path[j + 1]);
+    std::vector<Edge*> edges;
+    for (auto v : vertexSet) {
+        edges.clear();
+        for (Edge* e : v->adj) {
+            if (e != nullptr && e->getDest() != v) edges.push_back(e);
+        }
+        auto byDistance = [](Edge* a, Edge* b) { return a->getDistance() < b->getDistance(); };
+        if (edges.size() > (size_t) k) {
+            std::nth_element(edges.begin(), edges.begin() + k, edges.end(), byDistance);
+            edges.resize(k);
+        }
+        std::sort(edges.begin(), edges.end(), byDistance);
+        for (Edge* e : edges) candidates[v->getId()].push_back(e->getDest()->getId());
+    }
+    return candidates;
+}
 
-                if (newCost < oldCost) {
-                    std::reverse(path.begin() + i + 1, path.begin() + j + 1);
-                    cost -= oldCost - newCost;
-                    improved = true;
+double Graph::greedyEdge(std::vector<Vertex*> &path, int k) {
+    int n = getNumVertex();
+    path.clear();
+    if (n == 0) return -1.0;
+
+    struct Candidate {
+        double dist;
+        int u, v;
+        bool operator<(const Candidate &other) const {
+            if (dist != other.dist) return dist < other.dist;
+            if (u != other.u) return u < other.u;
+            return v < other.v;
+        }
+    };
+
+    UFDS sets(n);
+    std::vector<int> degree(n, 0);
+    std::vector<int> link(2 * n, -1);
+
+    // greedy matching: at most two tour edges per vertex and no premature cycle
+    auto match = [&](std::vector<Candidate> &candidates) {
+        std::sort(candidates.begin(), candidates.end());
+        int added = 0;
+        for (const Candidate &c : candidates) {
+            if (c.u == c.v || degree[c.u] == 2 || degree[c.v] == 2 || sets.isSameSet(c.u, c.v)) continue;
+            sets.linkSets(c.u, c.v);
+            link[2 * c.u + degree[c.u]++] = c.v;
+            link[2 * c.v + degree[c.v]++] = c.u;
+            added++;
+        }
+        return added;
+    };
+
+    std::vector<Candidate> candidates;
+    auto lists = candidateLists(k);
+    for (int u = 0; u < n; u++) {
+        for (int v : lists[u]) {
+            if (v < u && std::find(lists[v].begin(), lists[v].end(), u) != lists[v].end()) continue;
+            double d = calculateDistance(vertexSet[u], vertexSet[v]);
+            if (d != -1.0) candidates.push_back({d, std::min(u, v), std::max(u, v)});
+        }
+    }
+    lists.clear();
+    int fragmentCount = n - match(candidates);
+
+    // with coordinates, keep matching the free endpoints among themselves while that makes progress
+    const int joinLimit = 64;
+    if (hasCoords()) {
+        while (fragmentCount > joinLimit) {
+            std::vector<Vertex*> endpoints;
+            for (auto v : vertexSet) {
+                if (degree[v->getId()] < 2) endpoints.push_back(v);
+            }
+            SpatialIndex index(endpoints);
+            candidates.clear();
+            for (int i = 0; i < (int) endpoints.size(); i++) {
+                for (int j : index.nearest(i, k)) {
+                    int u = endpoints[i]->getId(), v = endpoints[j]->getId();
+                    if (sets.isSameSet(u, v)) continue;
+                    candidates.push_back({calculateDistance(endpoints[i], endpoints[j]), std::min(u, v), std::max(u, v)});
                 }
             }
+            int added = match(candidates);
+            if (added == 0) break;
+            fragmentCount -= added;
+        }
+    }
+
+    // walk every fragment from one of its endpoints
+    std::vector<std::vector<int>> fragments;
+    std::vector<bool> seen(n, false);
+    for (int start = 0; start < n; start++) {
+        if (seen[start] || degree[start] == 2) continue;
+        std::vector<int> fragment;
+        int prev = -1, curr = start;
+        while (curr != -1) {
+            seen[curr] = true;
+            fragment.push_back(curr);
+            int next = link[2 * curr] != prev ? link[2 * curr] : link[2 * curr + 1];
+            prev = curr;
+            curr = next;
         }
+        fragments.push_back(fragment);
+    }
+
+    // join the fragments by repeatedly moving to the closest free endpoint
+    std::vector<int> tour = fragments.back();
+    fragments.pop_back();
+    while (!fragments.empty()) {
+        Vertex* end = vertexSet[tour.back()];
+        double bestDist = -1.0;
+        size_t bestFragment = 0;
+        bool reversed = false;
+
+        for (size_t f = 0; f < fragments.size(); f++) {
+            double front = calculateDistance(end, vertexSet[fragments[f].front()]);
+            double back = calculateDistance(end, vertexSet[fragments[f].back()]);
+            if (front != -1.0 && (bestDist == -1.0 || front < bestDist)) {
+                bestDist = front;
+                bestFragment = f;
+                reversed = false;
+            }
+            if (back != -1.0 && (bestDist == -1.0 || back < bestDist)) {
+                bestDist = back;
+                bestFragment = f;
+                reversed = true;
+            }
+        }
+        if (bestDist == -1.0) return -1.0;
+
+        std::vector<int> &chosen = fragments[bestFragment];
+        if (reversed) tour.insert(tour.end(), chosen.rbegin(), chosen.rend());
+        else tour.insert(tour.end(), chosen.begin(), chosen.end());
+        std::swap(chosen, fragments.back());
+        fragments.pop_back();
+    }
+
+    std::rotate(tour.begin(), std::find(tour.begin(), tour.end(), 0), tour.end());
+    for (int id : tour) path.push_back(vertexSet[id]);
+    return tourCost(path);
+}
+
+double Graph::spaceFillingCurve(std::vector<Vertex*> &path) {
+    path.clear();
+    if (vertexSet.empty() || !hasCoords()) return -1.0;
+
+    std::vector<int> order = SpatialIndex::hilbertOrder(vertexSet);
+    std::rotate(order.begin(), std::find(order.begin(), order.end(), 0), order.end());
+    for (int id : order) path.push_back(vertexSet[id]);
+    return tourCost(path);
+}
+
+double Graph::tourCost(const std::vector<Vertex*> &path) {
+    if (path.empty()) return -1.0;
+    double cost = 0.0;
+    for (size_t i = 0; i < path.size(); i++) {
+        double d = calculateDistance(path[i], path[(i + 1) % path.size()]);
+        if (d == -1.0) return -1.0;
+        cost += d;
+    }
+    return cost;
+}
+
+bool Graph::hasCoords() const {
+    for (auto v : vertexSet) {
+        if (v == nullptr || v->getCoords() == nullptr) return false;
+    }
+    return true;
+}
+
+void Graph::attachCoords(const std::vector<std::pair<int, Coords>> &coords) {
+    for (auto &entry : coords) {
+        Vertex* vertex = findVertex(entry.first);
+        if (vertex != nullptr) vertex->setCoords(entry.second.longitude, entry.second.latitude);
+    }
+}
+
+bool Graph::setGeometry(std::shared_ptr<const Geometry> built) {
+    if (built == nullptr || built->size() != getNumVertex() || !hasCoords()) return false;
+    geometry = std::move(built);
+    return true;
+}
+
+bool Graph::buildGeometry() {
+    if (geometry == nullptr && hasCoords()) geometry = std::make_shared<const Geometry>(vertexSet);
+    return geometry != nullptr;
+}
+
+bool Graph::hasGeometry() const {
+    return geometry != nullptr;
+}
+
+double Graph::tspHeuristic(std::vector<Vertex*> &path, TourSeed seed) {
+    HeuristicOptions options;
+    options.seed = seed;
+    return tspHeuristic(path, options);
+}
+
+double Graph::tspHeuristic(std::vector<Vertex*> &path, const HeuristicOptions &options) {
+    path.clear();
+    if (!tourPossible(false)) return -1.0;
+
+    double cost;
+    switch (options.seed) {
+        case TourSeed::GreedyEdge:
+            cost = greedyEdge(path);
+            break;
+        case TourSeed::SpaceFillingCurve:
+            cost = spaceFillingCurve(path);
+            break;
+        default:
+            cost = nearestNeighbour(path);
+    }
+
+    if(cost == -1.0) return -1.0;
+
+    if (options.kernel == MoveKernel::GraphLookup) {
+        cost = twoOptCandidates(path, cost, 10);
+        if (!options.orOpt) return cost;
     }
 
+    const DistanceMatrix &distances = distanceMatrix();
+    std::vector<int> tour;
+    for (auto v : path) tour.push_back(v->getId());
+
+    bool simd = options.kernel == MoveKernel::MatrixSimd;
+    if (options.orOpt) LocalSearch::twoOptOrOpt(distances, tour, cost, simd);
+    else LocalSearch::twoOpt(distances, tour, cost, simd);
+
+    for (size_t i = 0; i < tour.size(); i++) path[i] = vertexSet[tour[i]];
+    return cost;
+}
+
+double Graph::tspMetaheuristic(std::vector<Vertex*> &path, const MetaheuristicOptions &options,
+                               std::vector<CostSample> &trace) {
+    HeuristicOptions start;
+    start.kernel = MoveKernel::MatrixSimd;
+    double cost = tspHeuristic(path, start);
+    if (cost == -1.0) return -1.0;
+
+    std::vector<int> tour;
+    for (auto v : path) tour.push_back(v->getId());
+    cost = Metaheuristic::run(distanceMatrix(), tour, cost, options, trace);
+
+    for (size_t i = 0; i < tour.size(); i++) path[i] = vertexSet[tour[i]];
+    return cost;
+}
+
+double Graph::twoOptCandidates(std::vector<Vertex*> &path, double cost, int k) {
+    std::vector<int> tour;
+    for (auto v : path) tour.push_back(v->getId());
+    auto distance = [this](int u, int v, double &d) {
+        d = calculateDistance(vertexSet[u], vertexSet[v]);
+        return d != -1.0;
+    };
+    cost = LocalSearch::twoOptCandidates(tour, candidateLists(k), distance, cost);
+    for (size_t i = 0; i < tour.size(); i++) path[i] = vertexSet[tour[i]];
     return cost;
 }
 
+const DistanceMatrix &Graph::distanceMatrix() {
+    if (matrix != nullptr && matrix->size() == getNumVertex()) return *matrix;
+
+    // big matrices are worth building in parallel
+    int n = getNumVertex();
+    if (n >= 512) {
+        ThreadPool pool(0, 0);
+        return distanceMatrix(pool);
+    }
+
+    matrix = std::make_shared<DistanceMatrix>(n);
+    for (int u = 0; u < n; u++) {
+        for (int v = 0; v < n; v++) {
+            if (u == v) continue;
+            double d = calculateDistance(vertexSet[u], vertexSet[v]);
+            if (d != -1.0) matrix->set(u, v, d);
+        }
+    }
+    return *matrix;
+}
+
+const DistanceMatrix &Graph::distanceMatrix(ThreadPool &pool) {
+    if (matrix != nullptr && matrix->size() == getNumVertex()) return *matrix;
+
+    int n = getNumVertex();
+    auto built = std::make_shared<DistanceMatrix>(n, pool);
+    pool.forEachWorker([this, n, &built, &pool](unsigned worker) {
+        int begin, end;
+        DistanceMatrix::rowBlock(n, worker, pool.size(), begin, end);
+        for (int u = begin; u < end; u++) {
+            for (int v = 0; v < n; v++) {
+                if (u == v) continue;
+                double d = calculateDistance(vertexSet[u], vertexSet[v]);
+                if (d != -1.0) built->set(u, v, d);
+            }
+        }
+    });
+    matrix = built;
+    return *matrix;
+}
+
+std::shared_ptr<const DistanceMatrix> Graph::sharedDistanceMatrix() {
+    distanceMatrix();
+    return matrix;
+}
+
+std::shared_ptr<const MetricClosure> Graph::metricClosure(unsigned threads) {
+    if (closure == nullptr || closure->size() != getNumVertex())
+        closure = std::make_shared<const MetricClosure>(*this, threads);
+    return closure;
+}
+
+const Connectivity &Graph::connectivity(unsigned threads) {
+    if (edgeConnectivity == nullptr) edgeConnectivity = std::make_shared<const Connectivity>(*this, threads);
+    return *edgeConnectivity;
+}
+
+bool Graph::tourPossible(bool edgesOnly) {
+    if (!edgesOnly && getNumVertex() >= 3 && hasCoords()) return true;
+    return connectivity().hamiltonianPossible();
+}
+
+void Graph::clearCaches() {
+    matrix.reset();
+    closure.reset();
+    edgeConnectivity.reset();
+    geometry.reset();
+}
+
+size_t Graph::evictDistances() {
+    size_t bytes = 0;
+    if (matrix != nullptr) bytes += matrix->memoryBytes();
+    if (closure != nullptr) bytes += closure->memoryBytes();
+    matrix.reset();
+    closure.reset();
+    return bytes;
+}
+
+GraphMemory Graph::memory() const {
+    GraphMemory res;
+    res.vertices = vertexSet.capacity() * sizeof(Vertex*);
+    res.coordinates = (originalIds.capacity() + internalIds.capacity()) * sizeof(int);
+    for (auto v : vertexSet) {
+        if (v == nullptr) continue;
+        res.vertices += sizeof(Vertex) + v->getDestVertexVector().capacity() * sizeof(int);
+        res.adjacency += v->adj.capacity() * sizeof(Edge*);
+        for (auto e : v->adj) {
+            if (e != nullptr) res.edges += sizeof(Edge);
+        }
+        if (v->getCoords() != nullptr) res.coordinates += sizeof(Coords);
+    }
+    if (matrix != nullptr) res.caches += matrix->memoryBytes();
+    if (closure != nullptr) res.caches += closure->memoryBytes();
+    if (edgeConnectivity != nullptr) res.caches += edgeConnectivity->memoryBytes();
+    if (geometry != nullptr) res.caches += geometry->memoryBytes();
+    return res;
+}
+
+size_t Graph::distanceMatrixBytes() const {
+    if (matrix != nullptr && matrix->size() == getNumVertex()) return 0;
+    return (size_t) getNumVertex() * getNumVertex() * sizeof(double);
+}
+
+
+bool Graph::renumber(VertexOrder order) {
+    int n = getNumVertex();
+    if (n == 0) return true;
+
+    // newOrder[new id] = current id
+    std::vector<int> newOrder;
+    switch (order) {
+        case VertexOrder::ReverseCuthillMcKee:
+            newOrder = cuthillMcKeeOrder();
+            break;
+        case VertexOrder::Hilbert:
+            if (!hasCoords()) return false;
+            newOrder = SpatialIndex::hilbertOrder(vertexSet);
+            break;
+        default:
+            newOrder.resize(n);
+            for (int id = 0; id < n; id++) newOrder[id] = internalId(id);
+    }
+    int first = internalId(0);
+    std::rotate(newOrder.begin(), std::find(newOrder.begin(), newOrder.end(), first), newOrder.end());
+
+    std::vector<int> oldOriginal(n);
+    for (int id = 0; id < n; id++) oldOriginal[id] = originalId(id);
+
+    std::vector<Vertex*> newSet(n);
+    originalIds.assign(n, 0);
+    internalIds.assign(n, -1);
+    for (int id = 0; id < n; id++) {
+        newSet[id] = vertexSet[newOrder[id]];
+        newSet[id]->setId(id);
+        newSet[id]->getDestVertexVector().clear();
+        originalIds[id] = oldOriginal[newOrder[id]];
+        internalIds[originalIds[id]] = id;
+    }
+    vertexSet = newSet;
+
+    // the adjacency vectors are indexed by destination id
+    for (auto v : vertexSet) {
+        std::vector<Edge*> adj;
+        for (auto e : v->adj) {
+            if (e != nullptr) v->add(adj, e);
+        }
+        v->adj = adj;
+    }
+
+    if (order == VertexOrder::Original) {
+        originalIds.clear();
+        internalIds.clear();
+    }
+    bool hadGeometry = geometry != nullptr;
+    clearCaches();
+    if (hadGeometry) buildGeometry();
+    return true;
+}
+
+std::vector<int> Graph::cuthillMcKeeOrder() const {
+    int n = getNumVertex();
+    std::vector<int> degree(n, 0);
+    for (auto v : vertexSet) {
+        for (auto e : v->adj) {
+            if (e != nullptr) degree[v->getId()]++;
+        }
+    }
+
+    std::vector<int> byDegree(n);
+    for (int id = 0; id < n; id++) byDegree[id] = id;
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&degree](int a, int b) { return degree[a] < degree[b]; });
+
+    std::vector<int> order;
+    std::vector<bool> seen(n, false);
+    std::vector<int> neighbours;
+    order.reserve(n);
+    for (int start : byDegree) {
+        if (seen[start]) continue;
+        seen[start] = true;
+        order.push_back(start);
+        for (size_t head = order.size() - 1; head < order.size(); head++) {
+            neighbours.clear();
+            for (auto e : vertexSet[order[head]]->adj) {
+                if (e != nullptr && !seen[e->getDest()->getId()]) neighbours.push_back(e->getDest()->getId());
+            }
+            std::sort(neighbours.begin(), neighbours.end(), [&degree](int a, int b) {
+                return degree[a] != degree[b] ? degree[a] < degree[b] : a < b;
+            });
+            for (int w : neighbours) {
+                seen[w] = true;
+                order.push_back(w);
+            }
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+int Graph::originalId(int id) const {
+    return originalIds.empty() ? id : originalIds[id];
+}
+
+int Graph::internalId(int id) const {
+    if (id < 0 || id >= getNumVertex()) return -1;
+    return internalIds.empty() ? id : internalIds[id];
+}
 
 int Graph::getNumVertex() const {
     return vertexSet.size();
@@ -0,0 +1,79 @@
+#include "../headers/GraphLoader.h"
+#include "../headers/Reader.h"
+
+#include <chrono>
+
+namespace {
+    double msSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * Coordinates read from a nodes file, and the geometry over them if they cover every id from 0 to the largest.
+     */
+    struct NodesBuffer {
+        std::vector<std::pair<int, Coords>> coords;
+        std::shared_ptr<const Geometry> geometry;
+        double ms = 0;
+    };
+
+    NodesBuffer readNodes(const std::string &nodesPath) {
+        auto start = std::chrono::steady_clock::now();
+        NodesBuffer res;
+        std::ifstream in(nodesPath);
+        res.coords = Reader::readCoords(in);
+
+        int largest = -1;
+        for (auto &entry : res.coords) largest = std::max(largest, entry.first);
+        std::vector<Coords> points(largest + 1);
+        std::vector<bool> seen(largest + 1, false);
+        size_t missing = points.size();
+        for (auto &entry : res.coords) {
+            if (entry.first < 0) continue;
+            points[entry.first] = entry.second;
+            if (!seen[entry.first]) missing--;
+            seen[entry.first] = true;
+        }
+        if (largest >= 0 && missing == 0) res.geometry = std::make_shared<const Geometry>(points);
+        res.ms = msSince(start);
+        return res;
+    }
+}
+
+GraphLoader::GraphLoader() = default;
+
+GraphLoader::GraphLoader(const std::string &edgesPath, const std::string &nodesPath)
+        : result(std::async(std::launch::async, &GraphLoader::load, edgesPath, nodesPath)) {}
+
+bool GraphLoader::pending() const {
+    return result.valid();
+}
+
+bool GraphLoader::ready() const {
+    return result.valid() && result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+LoadedGraph GraphLoader::take() {
+    return result.get();
+}
+
+LoadedGraph GraphLoader::load(const std::string &edgesPath, const std::string &nodesPath) {
+    auto start = std::chrono::steady_clock::now();
+    std::future<NodesBuffer> nodes;
+    if (!nodesPath.empty()) nodes = std::async(std::launch::async, readNodes, nodesPath);
+
+    LoadedGraph res;
+    std::ifstream edgesIn(edgesPath);
+    Reader::readEdges(edgesIn, res.graph);
+    res.times.edgesMs = msSince(start);
+
+    if (nodes.valid()) {
+        NodesBuffer buffer = nodes.get();
+        res.graph.attachCoords(buffer.coords);
+        res.graph.setGeometry(buffer.geometry);
+        res.times.nodesMs = buffer.ms;
+    }
+    res.graph.connectivity();
+    res.times.totalMs = msSince(start);
+    return res;
+}
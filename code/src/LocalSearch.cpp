@@ -0,0 +1,311 @@
+#include "../headers/LocalSearch.h"
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LOCALSEARCH_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    // smallest gain considered an improvement by Or-opt, so rounding errors cannot make it cycle
+    const double epsilon = 1e-7;
+
+    /**
+     * First j from the given one (up to n - 2) whose 2-opt move with i improves the penalized tour, -1 if none.
+     * succ holds the penalized length of the tour edge leaving each position, extraA and extraB the penalties of
+     * the edges of t[i] and t[i + 1].
+     */
+    int nextPenalizedMove(const double* rowA, const double* rowB, const double* extraA, const double* extraB,
+                          const int* t, const double* succ, int i, int j, int n) {
+        for (; j < n - 1; j++) {
+            int c = t[j], d = t[j + 1];
+            if (rowA[c] + extraA[c] + rowB[d] + extraB[d] < succ[i] + succ[j]) return j;
+        }
+        return -1;
+    }
+
+#ifdef LOCALSEARCH_HAS_AVX2
+    __attribute__((target("avx2")))
+    int nextPenalizedMoveAvx2(const double* rowA, const double* rowB, const double* extraA, const double* extraB,
+                              const int* t, const double* succ, int i, int j, int n) {
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        __m256d ab = _mm256_set1_pd(succ[i]);
+
+        for (; j + 4 <= n - 1; j += 4) {
+            __m128i c = _mm_loadu_si128((const __m128i*) (t + j));
+            __m128i d = _mm_loadu_si128((const __m128i*) (t + j + 1));
+            __m256d oldCost = _mm256_add_pd(ab, _mm256_loadu_pd(succ + j));
+            __m256d newCost = _mm256_add_pd(_mm256_mask_i32gather_pd(zero, rowA, c, all, 8),
+                                            _mm256_mask_i32gather_pd(zero, rowB, d, all, 8));
+            // penalties only add to the new edges, so the lanes that fail without them fail with them too
+            int mask = _mm256_movemask_pd(_mm256_cmp_pd(newCost, oldCost, _CMP_LT_OQ));
+            for (; mask != 0; mask &= mask - 1) {
+                int k = j + __builtin_ctz(mask), a = t[k], b = t[k + 1];
+                if (rowA[a] + extraA[a] + rowB[b] + extraB[b] < succ[i] + succ[k]) return k;
+            }
+        }
+        return nextPenalizedMove(rowA, rowB, extraA, extraB, t, succ, i, j, n);
+    }
+#endif
+}
+
+EdgePenalties::EdgePenalties(int n) : lists(n) {}
+
+void EdgePenalties::setWeight(double w) {
+    weight = w;
+}
+
+int EdgePenalties::count(int u, int v) const {
+    for (auto &p : lists[u]) {
+        if (p.first == v) return p.second;
+    }
+    return 0;
+}
+
+void EdgePenalties::add(int u, int v) {
+    increment(u, v);
+    increment(v, u);
+}
+
+void EdgePenalties::spread(int u, std::vector<double> &row) const {
+    for (auto &p : lists[u]) row[p.first] = weight * p.second;
+}
+
+void EdgePenalties::clear(int u, std::vector<double> &row) const {
+    for (auto &p : lists[u]) row[p.first] = 0.0;
+}
+
+void EdgePenalties::increment(int u, int v) {
+    for (auto &p : lists[u]) {
+        if (p.first == v) {
+            p.second++;
+            return;
+        }
+    }
+    lists[u].emplace_back(v, 1);
+}
+
+bool LocalSearch::simdAvailable() {
+#ifdef LOCALSEARCH_HAS_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+double LocalSearch::nearestNeighbour(const DistanceMatrix &matrix, std::vector<int> &tour) {
+    int n = matrix.size();
+    tour.clear();
+    if (n == 0) return -1.0;
+
+    std::vector<bool> visited(n, false);
+    tour.push_back(0);
+    visited[0] = true;
+    double cost = 0;
+    while ((int) tour.size() < n) {
+        const double* row = matrix.row(tour.back());
+        int next = -1;
+        for (int v = 0; v < n; v++) {
+            if (!visited[v] && matrix.known(tour.back(), v) && (next == -1 || row[v] < row[next])) next = v;
+        }
+        if (next == -1) return -1.0;
+        cost += row[next];
+        visited[next] = true;
+        tour.push_back(next);
+    }
+    if (!matrix.known(tour.back(), 0)) return -1.0;
+    return cost + matrix.at(tour.back(), 0);
+}
+
+bool LocalSearch::twoOpt(const DistanceMatrix &matrix, std::vector<int> &tour, double &cost, bool simd) {
+    if (tour.size() < 4) return false;
+    if (simd && simdAvailable()) return twoOptAvx2(matrix, tour, cost);
+    return twoOptScalar(matrix, tour, cost);
+}
+
+bool LocalSearch::twoOptScalar(const DistanceMatrix &matrix, std::vector<int> &tour, double &cost) {
+    int n = (int) tour.size();
+    bool any = false;
+    bool improved = true;
+    while (improved) {
+        improved = false;
+
+        for (int i = 0; i < n - 2; i++) {
+            for (int j = i + 2; j < n - 1; j++) {
+                double oldCost = matrix.at(tour[i], tour[i + 1]) + matrix.at(tour[j], tour[j + 1]);
+                double newCost = matrix.at(tour[i], tour[j]) + matrix.at(tour[i + 1], tour[j + 1]);
+
+                if (newCost < oldCost) {
+                    std::reverse(tour.begin() + i + 1, tour.begin() + j + 1);
+                    cost -= oldCost - newCost;
+                    improved = any = true;
+                }
+            }
+        }
+    }
+    return any;
+}
+
+#ifdef LOCALSEARCH_HAS_AVX2
+__attribute__((target("avx2")))
+bool LocalSearch::twoOptAvx2(const DistanceMatrix &matrix, std::vector<int> &tour, double &cost) {
+    int n = (int) tour.size();
+    const int* t = tour.data();
+
+    // succ[k] is the length of the tour edge leaving position k
+    std::vector<double> succ(n - 1);
+    for (int k = 0; k < n - 1; k++) succ[k] = matrix.at(t[k], t[k + 1]);
+
+    // the masked gather with a zeroed source, since the plain one leaves its source operand undefined
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+    bool any = false;
+    bool improved = true;
+    while (improved) {
+        improved = false;
+
+        for (int i = 0; i < n - 2; i++) {
+            int j = i + 2;
+            while (j < n - 1) {
+                const double* rowA = matrix.row(t[i]);
+                const double* rowB = matrix.row(t[i + 1]);
+                __m256d ab = _mm256_set1_pd(succ[i]);
+
+                int found = -1;
+                for (; j + 4 <= n - 1; j += 4) {
+                    __m128i c = _mm_loadu_si128((const __m128i*) (t + j));
+                    __m128i d = _mm_loadu_si128((const __m128i*) (t + j + 1));
+                    __m256d oldCost = _mm256_add_pd(ab, _mm256_loadu_pd(succ.data() + j));
+                    __m256d newCost = _mm256_add_pd(_mm256_mask_i32gather_pd(zero, rowA, c, all, 8),
+                                                    _mm256_mask_i32gather_pd(zero, rowB, d, all, 8));
+                    int mask = _mm256_movemask_pd(_mm256_cmp_pd(newCost, oldCost, _CMP_LT_OQ));
+                    if (mask != 0) {
+                        found = j + __builtin_ctz(mask);
+                        break;
+                    }
+                }
+                for (; found < 0 && j < n - 1; j++) {
+                    if (rowA[t[j]] + rowB[t[j + 1]] < succ[i] + succ[j]) found = j;
+                }
+                if (found < 0) break;
+
+                double oldCost = succ[i] + succ[found];
+                double newCost = rowA[t[found]] + rowB[t[found + 1]];
+                std::reverse(tour.begin() + i + 1, tour.begin() + found + 1);
+                for (int k = i; k <= found; k++) succ[k] = matrix.at(t[k], t[k + 1]);
+                cost -= oldCost - newCost;
+                improved = any = true;
+                j = found + 1;
+            }
+        }
+    }
+    return any;
+}
+#else
+bool LocalSearch::twoOptAvx2(const DistanceMatrix &matrix, std::vector<int> &tour, double &cost) {
+    return twoOptScalar(matrix, tour, cost);
+}
+#endif
+
+bool LocalSearch::twoOpt(const DistanceMatrix &matrix, const EdgePenalties &penalties, std::vector<int> &tour,
+                         bool simd) {
+    int n = (int) tour.size();
+    if (n < 4) return false;
+#ifdef LOCALSEARCH_HAS_AVX2
+    auto next = simd && simdAvailable() ? nextPenalizedMoveAvx2 : nextPenalizedMove;
+#else
+    auto next = nextPenalizedMove;
+#endif
+    const int* t = tour.data();
+
+    // succ[k] is the penalized length of the tour edge leaving position k
+    std::vector<double> succ(n - 1);
+    for (int k = 0; k < n - 1; k++) succ[k] = matrix.at(t[k], t[k + 1]) + penalties.extra(t[k], t[k + 1]);
+    std::vector<double> extraA(n, 0.0), extraB(n, 0.0);
+
+    bool any = false;
+    bool improved = true;
+    while (improved) {
+        improved = false;
+
+        for (int i = 0; i < n - 2; i++) {
+            penalties.spread(t[i], extraA);
+            penalties.spread(t[i + 1], extraB);
+            int j = i + 2;
+            while (true) {
+                int found = next(matrix.row(t[i]), matrix.row(t[i + 1]), extraA.data(), extraB.data(), t,
+                                 succ.data(), i, j, n);
+                if (found < 0) break;
+
+                penalties.clear(t[i + 1], extraB);
+                std::reverse(tour.begin() + i + 1, tour.begin() + found + 1);
+                for (int k = i; k <= found; k++) succ[k] = matrix.at(t[k], t[k + 1]) + penalties.extra(t[k], t[k + 1]);
+                penalties.spread(t[i + 1], extraB);
+                improved = any = true;
+                j = found + 1;
+            }
+            penalties.clear(t[i], extraA);
+            penalties.clear(t[i + 1], extraB);
+        }
+    }
+    return any;
+}
+
+bool LocalSearch::orOpt(const DistanceMatrix &matrix, std::vector<int> &tour, double &cost) {
+    int n = (int) tour.size();
+    if (n < 5) return false;
+
+    bool any = false;
+    bool improved = true;
+    std::vector<int> segment;
+    while (improved) {
+        improved = false;
+
+        for (int len = 1; len <= 3; len++) {
+            for (int s = 1; s + len - 1 <= n - 1; s++) {
+                int e = s + len - 1;
+                int prev = tour[s - 1], next = tour[(e + 1) % n];
+                int first = tour[s], last = tour[e];
+                double removeGain = matrix.at(prev, first) + matrix.at(last, next) - matrix.at(prev, next);
+                if (!(removeGain > epsilon)) continue;
+
+                for (int k = 0; k < n; k++) {
+                    if (k >= s - 1 && k <= e) continue;
+                    int x = tour[k], y = tour[(k + 1) % n];
+                    double forward = matrix.at(x, first) + matrix.at(last, y) - matrix.at(x, y);
+                    double backward = matrix.at(x, last) + matrix.at(first, y) - matrix.at(x, y);
+                    bool reversed = backward < forward;
+                    double addCost = reversed ? backward : forward;
+                    if (!(addCost < removeGain - epsilon)) continue;
+
+                    segment.assign(tour.begin() + s, tour.begin() + e + 1);
+                    if (reversed) std::reverse(segment.begin(), segment.end());
+                    tour.erase(tour.begin() + s, tour.begin() + e + 1);
+                    int position = k < s ? k + 1 : k - len + 1;
+                    tour.insert(tour.begin() + position, segment.begin(), segment.end());
+                    cost -= removeGain - addCost;
+                    improved = any = true;
+                    break;
+                }
+            }
+        }
+    }
+    return any;
+}
+
+bool LocalSearch::twoOptOrOpt(const DistanceMatrix &matrix, std::vector<int> &tour, double &cost, bool simd) {
+    bool any = twoOpt(matrix, tour, cost, simd);
+    while (orOpt(matrix, tour, cost)) {
+        any = true;
+        if (!twoOpt(matrix, tour, cost, simd)) break;
+    }
+    return any;
+}
+
+double LocalSearch::tourCost(const DistanceMatrix &matrix, const std::vector<int> &tour) {
+    double cost = 0.0;
+    for (size_t i = 0; i < tour.size(); i++) cost += matrix.at(tour[i], tour[(i + 1) % tour.size()]);
+    return cost;
+}
@@ -0,0 +1,200 @@
+#include "../headers/LowerBound.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+LowerBound::Mode LowerBound::mode(Graph &graph) {
+    size_t edges = 0;
+    for (auto v : graph.getVertexSet()) {
+        for (auto e : v->adj) if (e != nullptr) edges++;
+    }
+    int n = graph.getNumVertex();
+    bool dense = graph.hasCoords() || edges >= (size_t) n * (n - 1);
+    if (!dense) return Mode::Sparse;
+    // a matrix that is already cached is used whatever its size
+    if (n <= matrixLimit || graph.distanceMatrixBytes() == 0) return Mode::Matrix;
+    if (n <= denseLimit) return Mode::OnTheFly;
+    return Mode::TooLarge;
+}
+
+double LowerBound::improve(Graph &graph, long timeBudgetMs, double upperBound) {
+    int n = graph.getNumVertex();
+    switch (mode(graph)) {
+        case Mode::Sparse:
+            return run(n, timeBudgetMs, upperBound, [&graph, this](std::vector<int> &degree) {
+                return oneTreeSparse(graph, degree);
+            });
+        case Mode::Matrix:
+            return improve(graph.distanceMatrix(), timeBudgetMs, upperBound);
+        case Mode::OnTheFly: {
+            std::vector<Vertex*> vertices = graph.getVertexSet();
+            auto distance = [&graph, &vertices](int u, int v) {
+                double d = graph.calculateDistance(vertices[u], vertices[v]);
+                return d == -1.0 ? DistanceMatrix::unknown() : d;
+            };
+            return run(n, timeBudgetMs, upperBound, [n, &distance, this](std::vector<int> &degree) {
+                return oneTreeDense(n, distance, degree);
+            });
+        }
+        default:
+            return best;
+    }
+}
+
+double LowerBound::improve(const DistanceMatrix &matrix, long timeBudgetMs, double upperBound) {
+    int n = matrix.size();
+    auto distance = [&matrix](int u, int v) { return matrix.at(u, v); };
+    return run(n, timeBudgetMs, upperBound, [n, &distance, this](std::vector<int> &degree) {
+        return oneTreeDense(n, distance, degree);
+    });
+}
+
+double LowerBound::run(int n, long timeBudgetMs, double upperBound,
+                       const std::function<double(std::vector<int>&)> &oneTree) {
+    if (n < 3 || optimal) return best;
+    if (penalty.empty()) penalty.assign(n, 0.0);
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&start]() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::vector<int> degree(n);
+    // halve the step after this many iterations without improvement
+    const int patience = std::max(10, n / 10);
+
+    do {
+        std::fill(degree.begin(), degree.end(), 0);
+        double treeCost = oneTree(degree);
+        if (treeCost == -1.0) return best = -1.0;
+
+        double bound = treeCost;
+        double norm = 0;
+        for (int v = 0; v < n; v++) {
+            bound -= 2 * penalty[v];
+            norm += (degree[v] - 2) * (degree[v] - 2);
+        }
+
+        if (bound > best + 1e-9) {
+            best = bound;
+            sinceImprovement = 0;
+        } else if (++sinceImprovement >= patience) {
+            lambda /= 2;
+            sinceImprovement = 0;
+        }
+        if (norm == 0) {
+            optimal = true;
+            break;
+        }
+        if (lambda < 1e-6) break;
+
+        // Polyak step towards the upper bound, or a fraction of the bound if no tour is known
+        double gap = upperBound > bound ? upperBound - bound : 0.01 * std::abs(bound) + 1;
+        double step = lambda * gap / norm;
+        for (int v = 0; v < n; v++) penalty[v] += step * (degree[v] - 2);
+    } while (elapsed() < timeBudgetMs);
+
+    return best;
+}
+
+double LowerBound::getBound() const {
+    return best;
+}
+
+bool LowerBound::isOptimal() const {
+    return optimal;
+}
+
+template <class Distance>
+double LowerBound::oneTreeDense(int n, const Distance &distance, std::vector<int> &degree) {
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    // Prim over vertices 1..n-1, O(V²) with an array of keys
+    std::vector<double> key(n, infinity);
+    std::vector<int> link(n, -1);
+    std::vector<bool> inTree(n, false);
+    double cost = 0;
+    key[1] = 0;
+    for (int added = 0; added < n - 1; added++) {
+        int u = -1;
+        for (int v = 1; v < n; v++) {
+            if (!inTree[v] && (u == -1 || key[v] < key[u])) u = v;
+        }
+        if (key[u] == infinity) return -1.0;
+        inTree[u] = true;
+        cost += key[u];
+        if (link[u] != -1) {
+            degree[u]++;
+            degree[link[u]]++;
+        }
+
+        for (int v = 1; v < n; v++) {
+            if (inTree[v]) continue;
+            double w = distance(u, v) + penalty[u] + penalty[v];
+            if (w < key[v]) {
+                key[v] = w;
+                link[v] = u;
+            }
+        }
+    }
+
+    // the two cheapest edges of vertex 0
+    double first = infinity, second = infinity;
+    int firstV = -1, secondV = -1;
+    for (int v = 1; v < n; v++) {
+        double w = distance(0, v) + penalty[0] + penalty[v];
+        if (w < first) {
+            second = first;
+            secondV = firstV;
+            first = w;
+            firstV = v;
+        } else if (w < second) {
+            second = w;
+            secondV = v;
+        }
+    }
+    if (second == infinity) return -1.0;
+    degree[0] = 2;
+    degree[firstV]++;
+    degree[secondV]++;
+    return cost + first + second;
+}
+
+double LowerBound::oneTreeSparse(Graph &graph, std::vector<int> &degree) {
+    Vertex* special = graph.findVertex(0);
+    auto tree = graph.mstPrim(penalty, special);
+    if ((int) tree.size() != graph.getNumVertex() - 1) return -1.0;
+
+    // every vertex but the root of the tree must have been reached
+    double cost = 0;
+    for (size_t i = 1; i < tree.size(); i++) {
+        Vertex* v = tree[i];
+        if (v->getPath() == nullptr) return -1.0;
+        cost += v->getDist();
+        degree[v->getId()]++;
+        degree[v->getPath()->getOrig()->getId()]++;
+    }
+
+    double first = std::numeric_limits<double>::infinity(), second = first;
+    int firstV = -1, secondV = -1;
+    for (auto e : special->adj) {
+        if (e == nullptr || e->getDest() == special) continue;
+        int v = e->getDest()->getId();
+        double w = e->getDistance() + penalty[0] + penalty[v];
+        if (w < first) {
+            second = first;
+            secondV = firstV;
+            first = w;
+            firstV = v;
+        } else if (w < second) {
+            second = w;
+            secondV = v;
+        }
+    }
+    if (secondV == -1) return -1.0;
+    degree[0] = 2;
+    degree[firstV]++;
+    degree[secondV]++;
+    return cost + first + second;
+}
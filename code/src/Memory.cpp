@@ -0,0 +1,65 @@
+#include "../headers/Memory.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    std::atomic<size_t> budget{0};
+
+    /**
+     * Parses a line of /proc/self/status or /proc/meminfo such as "VmRSS:     1234 kB".
+     */
+    size_t kilobytes(const std::string &line) {
+        std::stringstream ss(line.substr(line.find(':') + 1));
+        size_t kb = 0;
+        ss >> kb;
+        return kb * 1024;
+    }
+}
+
+void MemoryBudget::setLimit(size_t bytes) {
+    budget = bytes;
+}
+
+size_t MemoryBudget::limit() {
+    return budget;
+}
+
+ProcessMemory MemoryBudget::process() {
+    ProcessMemory res;
+    std::ifstream in("/proc/self/status");
+    for (std::string line; std::getline(in, line);) {
+        if (line.compare(0, 6, "VmRSS:") == 0) res.residentBytes = kilobytes(line);
+        else if (line.compare(0, 6, "VmHWM:") == 0) res.peakBytes = kilobytes(line);
+    }
+    return res;
+}
+
+size_t MemoryBudget::available() {
+    std::ifstream in("/proc/meminfo");
+    for (std::string line; std::getline(in, line);) {
+        if (line.compare(0, 13, "MemAvailable:") == 0) return kilobytes(line);
+    }
+    return 0;
+}
+
+bool MemoryBudget::fits(size_t bytes) {
+    size_t limit = budget;
+    if (limit == 0) return true;
+    size_t resident = process().residentBytes;
+    return resident <= limit && bytes <= limit - resident;
+}
+
+std::string MemoryBudget::format(size_t bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    double value = (double) bytes;
+    int unit = 0;
+    while (value >= 1024 && unit < 4) {
+        value /= 1024;
+        unit++;
+    }
+    char text[32];
+    std::snprintf(text, sizeof(text), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+    return text;
+}
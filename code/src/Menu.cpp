@@ -1,14 +1,52 @@
+#include <algorithm>
 #include <fstream>
 #include "../headers/Menu.h"
 
 Menu::Menu() {
     printer = readSelectedFile();
+    chooseVertexOrder();
+}
+
+void Menu::chooseOutput() {
+    std::cout << "[1] Plain ids" << std::endl;
+    std::cout << "[2] CSV" << std::endl;
+    std::cout << "[3] Binary" << std::endl;
+    std::string option, path;
+    std::cout << "Press one of the options: ";
+    std::getline(std::cin,option);
+    std::cout << "Output file (empty for the terminal): ";
+    std::getline(std::cin,path);
+    std::cout << std::endl;
+
+    outputFormat = OutputFormat::Plain;
+    if (option == "2") outputFormat = OutputFormat::Csv;
+    else if (option == "3") {
+        if (path.empty()) std::cout << "The binary format needs a file, using plain ids." << std::endl;
+        else outputFormat = OutputFormat::Binary;
+    }
+    outputPath = path;
+    printer.setOutput(outputPath, outputFormat);
+}
+
+void Menu::chooseVertexOrder() {
+    std::cout << "[1] Keep the vertex ids of the file" << std::endl;
+    std::cout << "[2] Renumber vertices by reverse Cuthill-McKee" << std::endl;
+    std::cout << "[3] Renumber vertices along a Hilbert curve" << std::endl;
+    std::string option;
+    std::cout << "Press one of the options: ";
+    std::getline(std::cin,option);
+    std::cout << std::endl;
+
+    if (option == "2") printer.renumber(VertexOrder::ReverseCuthillMcKee);
+    else if (option == "3") printer.renumber(VertexOrder::Hilbert);
 }
 
 Printer Menu::readSelectedFile() {
     std::cout << "[1] Read real graph" << std::endl;
     std::cout << "[2] Read toy graph" << std::endl;
     std::cout << "[3] Read medium graph" << std::endl;
+    std::cout << "[4] Read generated graph" << std::endl;
+    std::cout << "[5] Solve a generated graph in compact storage only (for graphs too large to load)" << std::endl;
     std::string option, graphChosen;
 
     while(true) {
@@ -104,6 +142,22 @@ Printer Menu::readSelectedFile() {
                 std::cout << std::endl;
             }
         }
+        else if(option == "4"){
+            std::string directory;
+            std::cout << "Directory written by feup_da_proj2_generator: ";
+            std::getline(std::cin,directory);
+            std::cout << std::endl;
+            return {directory + "/edges.csv", directory + "/nodes.csv"};
+        }
+        else if(option == "5"){
+            std::string directory;
+            std::cout << "Directory written by feup_da_proj2_generator: ";
+            std::getline(std::cin,directory);
+            std::cout << std::endl;
+            Printer::printCompactFile(directory + "/edges.csv", directory + "/nodes.csv");
+            std::cout << std::endl;
+            std::cout << "Pick a graph to load, [1] to [5]" << std::endl;
+        }
         std::cout << std::endl;
     }
 }
@@ -112,12 +166,19 @@ void Menu::run() {
     while(true){
         std::string option;
         std::cout << "MAIN MENU" << std::endl;
+        if (printer.isLoading())
+            std::cout << "(The graph is still loading, options that need it will wait for it)" << std::endl;
         std::cout << "[1] Print graph contents" << std::endl;
         std::cout << "[2] Cost with the Backtracking Algorithm" << std::endl;
         std::cout << "[3] Cost with the Triangular Approximation Heuristic" << std::endl;
         std::cout << "[4] Cost with Other Heuristics" << std::endl;
-        std::cout << "[5] Choose a different graph" << std::endl;
-        std::cout << "[6] Exit" << std::endl;
+        std::cout << "[5] Cost with a Metaheuristic" << std::endl;
+        std::cout << "[6] Compare compact storage modes" << std::endl;
+        std::cout << "[7] Solve a batch of sub-tours" << std::endl;
+        std::cout << "[8] Use shortest-path distances: " << (printer.usesShortestPaths() ? "on" : "off") << std::endl;
+        std::cout << "[9] Output format and destination" << std::endl;
+        std::cout << "[10] Choose a different graph" << std::endl;
+        std::cout << "[11] Exit" << std::endl;
         std::cout << "Press one of the options: ";
         std::getline(std::cin,option);
         std::cout << std::endl;
@@ -130,11 +191,99 @@ void Menu::run() {
             if(this->isShippingGraph) printer.printCostAndPathTAH(isShippingGraph);
             else printer.printCostAndPathTAH(isShippingGraph);
         }else if (option == "4") {
-            printer.printCostAndPathHeuristic();
+            HeuristicOptions options;
+            std::cout << "[1] Nearest neighbour" << std::endl;
+            std::cout << "[2] Greedy edge" << std::endl;
+            std::cout << "[3] Space-filling curve" << std::endl;
+            std::string seed;
+            std::cout << "Press one of the options: ";
+            std::getline(std::cin,seed);
+            std::cout << std::endl;
+
+            if (seed == "2") options.seed = TourSeed::GreedyEdge;
+            else if (seed == "3") options.seed = TourSeed::SpaceFillingCurve;
+
+            std::cout << "[1] 2-opt" << std::endl;
+            std::cout << "[2] 2-opt over the distance matrix" << std::endl;
+            std::cout << "[3] 2-opt over the distance matrix (AVX2)" << std::endl;
+            std::cout << "[4] 2-opt + Or-opt (AVX2)" << std::endl;
+            std::string improvement;
+            std::cout << "Press one of the options: ";
+            std::getline(std::cin,improvement);
+            std::cout << std::endl;
+
+            if (improvement == "2") options.kernel = MoveKernel::MatrixScalar;
+            else if (improvement == "3") options.kernel = MoveKernel::MatrixSimd;
+            else if (improvement == "4") {
+                options.kernel = MoveKernel::MatrixSimd;
+                options.orOpt = true;
+            }
+
+            printer.printCostAndPathHeuristic(options);
         }else if (option == "5") {
+            MetaheuristicOptions options;
+            std::cout << "[1] Simulated annealing" << std::endl;
+            std::cout << "[2] Guided local search" << std::endl;
+            std::cout << "[3] Iterated local search" << std::endl;
+            std::string kind, budget, seed;
+            std::cout << "Press one of the options: ";
+            std::getline(std::cin,kind);
+            std::cout << std::endl;
+
+            if (kind == "2") options.kind = MetaheuristicKind::GuidedLocalSearch;
+            else if (kind == "3") options.kind = MetaheuristicKind::IteratedLocalSearch;
+            else {
+                std::string cooling;
+                std::cout << "[1] Linear cooling over the budget" << std::endl;
+                std::cout << "[2] Geometric cooling with restarts" << std::endl;
+                std::cout << "Press one of the options: ";
+                std::getline(std::cin,cooling);
+                std::cout << std::endl;
+                if (cooling == "2") options.cooling = CoolingSchedule::Geometric;
+            }
+
+            std::cout << "Time budget in seconds (default 10): ";
+            std::getline(std::cin,budget);
+            std::cout << "Random seed (default 1): ";
+            std::getline(std::cin,seed);
+            std::cout << std::endl;
+
+            try {
+                if (!budget.empty()) options.timeBudgetMs = (long) (std::stod(budget) * 1000);
+                if (!seed.empty()) options.seed = std::stoul(seed);
+            } catch (const std::exception&) {
+                std::cout << "Invalid number, using the defaults." << std::endl;
+            }
+
+            printer.printCostAndPathMetaheuristic(options);
+        }else if (option == "6") {
+            printer.printCompactStorage();
+        }else if (option == "7") {
+            BatchOptions options;
+            std::string subsetsPath, threshold;
+            std::cout << "Subsets file (one list of vertex ids per line): ";
+            std::getline(std::cin,subsetsPath);
+            std::cout << "Largest subset solved exactly (default 13, at most 24): ";
+            std::getline(std::cin,threshold);
+            std::cout << std::endl;
+
+            try {
+                if (!threshold.empty()) options.exactThreshold = std::min(BatchSolver::maxExact, std::stoi(threshold));
+            } catch (const std::exception&) {
+                std::cout << "Invalid number, using the default." << std::endl;
+            }
+
+            printer.printBatch(subsetsPath, options);
+        }else if (option == "8") {
+            printer.setShortestPaths(!printer.usesShortestPaths());
+        }else if (option == "9") {
+            chooseOutput();
+        }else if (option == "10") {
             this->isShippingGraph = false;
             printer = readSelectedFile();
-        }else if (option == "6") {
+            printer.setOutput(outputPath, outputFormat);
+            chooseVertexOrder();
+        }else if (option == "11") {
             break;
         }else{
             std::cout << "FATAL ERROR (core dumped)" << std::endl;
@@ -0,0 +1,256 @@
+#include "../headers/Metaheuristic.h"
+#include "../headers/LocalSearch.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace {
+    class Clock {
+    public:
+        Clock() : start(std::chrono::steady_clock::now()) {}
+        long elapsed() const {
+            return (long) std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+        }
+    private:
+        std::chrono::steady_clock::time_point start;
+    };
+
+    bool finished(const Clock &clock, const MetaheuristicOptions &options, long iterations) {
+        if (options.maxIterations > 0 && iterations >= options.maxIterations) return true;
+        return clock.elapsed() >= options.timeBudgetMs;
+    }
+
+    /**
+     * For each vertex, its k closest vertices according to the matrix.
+     */
+    std::vector<std::vector<int>> nearestLists(const DistanceMatrix &matrix, int k) {
+        int n = matrix.size();
+        k = std::min(k, n - 1);
+        std::vector<std::vector<int>> lists(n);
+        std::vector<int> others;
+        for (int u = 0; u < n; u++) {
+            others.clear();
+            for (int v = 0; v < n; v++) {
+                if (v != u && matrix.known(u, v)) others.push_back(v);
+            }
+            auto closer = [&](int a, int b) { return matrix.at(u, a) < matrix.at(u, b); };
+            int size = std::min<int>(k, (int) others.size());
+            std::partial_sort(others.begin(), others.begin() + size, others.end(), closer);
+            lists[u].assign(others.begin(), others.begin() + size);
+        }
+        return lists;
+    }
+
+    /**
+     * Picks a random 2-opt move that replaces the tour edges leaving positions i and j (i + 2 <= j), such that the
+     * new edge joins a vertex to one of its nearest vertices.
+     * @return False if the picked pair does not form a valid move
+     */
+    bool randomMove(std::mt19937_64 &rng, const std::vector<int> &tour, const std::vector<int> &position,
+                    const std::vector<std::vector<int>> &nearest, int &i, int &j) {
+        int n = (int) tour.size();
+        i = std::uniform_int_distribution<int>(0, n - 1)(rng);
+        const std::vector<int> &candidates = nearest[tour[i]];
+        if (candidates.empty()) return false;
+        j = position[candidates[std::uniform_int_distribution<int>(0, (int) candidates.size() - 1)(rng)]];
+        // the new edges are (tour[i], tour[j]) and (tour[i + 1], tour[j + 1])
+        if (i > j) std::swap(i, j);
+        return j >= i + 2 && !(i == 0 && j == n - 1);
+    }
+
+    double moveDelta(const DistanceMatrix &matrix, const std::vector<int> &tour, int i, int j) {
+        int n = (int) tour.size();
+        int a = tour[i], b = tour[i + 1], c = tour[j], d = tour[(j + 1) % n];
+        return matrix.at(a, c) + matrix.at(b, d) - matrix.at(a, b) - matrix.at(c, d);
+    }
+}
+
+double Metaheuristic::run(const DistanceMatrix &matrix, std::vector<int> &tour, double cost,
+                          const MetaheuristicOptions &options, std::vector<CostSample> &trace) {
+    trace.clear();
+    trace.push_back({0, cost});
+    if (tour.size() < 5) return cost;
+
+    switch (options.kind) {
+        case MetaheuristicKind::GuidedLocalSearch:
+            return guidedLocalSearch(matrix, tour, cost, options, trace);
+        case MetaheuristicKind::IteratedLocalSearch:
+            return iteratedLocalSearch(matrix, tour, cost, options, trace);
+        default:
+            return simulatedAnnealing(matrix, tour, cost, options, trace);
+    }
+}
+
+double Metaheuristic::simulatedAnnealing(const DistanceMatrix &matrix, std::vector<int> &tour, double cost,
+                                         const MetaheuristicOptions &options, std::vector<CostSample> &trace) {
+    Clock clock;
+    int n = (int) tour.size();
+    std::mt19937_64 rng(options.seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    int i, j;
+
+    std::vector<std::vector<int>> nearest = nearestLists(matrix, 8);
+    std::vector<int> position(n);
+    for (int k = 0; k < n; k++) position[tour[k]] = k;
+
+    // start where about 2% of the average worsening candidate move would be accepted
+    double t0 = options.initialTemperature;
+    if (t0 <= 0) {
+        double sum = 0;
+        int count = 0;
+        for (int k = 0; k < 1000; k++) {
+            if (!randomMove(rng, tour, position, nearest, i, j)) continue;
+            double delta = moveDelta(matrix, tour, i, j);
+            if (delta > 0 && std::isfinite(delta)) {
+                sum += delta;
+                count++;
+            }
+        }
+        t0 = count > 0 ? (sum / count) / std::log(50.0) : cost / n;
+    }
+
+    std::vector<int> best = tour;
+    double bestCost = cost;
+    double temperature = t0;
+    const long restartAfter = std::max(100000L, 50L * n);
+    long iterations = 0, sinceBest = 0;
+
+    while (true) {
+        if ((iterations & 1023) == 0) {
+            if (finished(clock, options, iterations)) break;
+            if (options.cooling == CoolingSchedule::Linear && options.maxIterations > 0)
+                temperature = t0 * (1.0 - (double) iterations / options.maxIterations);
+            else if (options.cooling == CoolingSchedule::Linear)
+                temperature = t0 * (1.0 - (double) clock.elapsed() / options.timeBudgetMs);
+        }
+        if (options.maxIterations > 0 && iterations >= options.maxIterations) break;
+        iterations++;
+        sinceBest++;
+
+        if (randomMove(rng, tour, position, nearest, i, j)) {
+            double delta = moveDelta(matrix, tour, i, j);
+            if (std::isfinite(delta) &&
+                (delta < 0 || (temperature > 0 && uniform(rng) < std::exp(-delta / temperature)))) {
+                std::reverse(tour.begin() + i + 1, tour.begin() + j + 1);
+                for (int k = i + 1; k <= j; k++) position[tour[k]] = k;
+                cost += delta;
+                if (cost < bestCost - 1e-9) {
+                    best = tour;
+                    bestCost = cost;
+                    sinceBest = 0;
+                    trace.push_back({clock.elapsed(), bestCost});
+                }
+            }
+        }
+
+        if (options.cooling == CoolingSchedule::Geometric) temperature *= options.coolingRate;
+
+        // restart from the best tour when the search has frozen or stalled
+        bool frozen = options.cooling == CoolingSchedule::Geometric && temperature < t0 * 1e-6;
+        if (frozen || sinceBest > restartAfter) {
+            tour = best;
+            cost = bestCost;
+            for (int k = 0; k < n; k++) position[tour[k]] = k;
+            sinceBest = 0;
+            if (options.cooling == CoolingSchedule::Geometric) temperature = t0;
+        }
+    }
+
+    tour = best;
+    LocalSearch::twoOpt(matrix, tour, bestCost, true);
+    cost = LocalSearch::tourCost(matrix, tour);
+    if (cost < trace.back().cost) trace.push_back({clock.elapsed(), cost});
+    return cost;
+}
+
+double Metaheuristic::guidedLocalSearch(const DistanceMatrix &matrix, std::vector<int> &tour, double cost,
+                                        const MetaheuristicOptions &options, std::vector<CostSample> &trace) {
+    Clock clock;
+    int n = (int) tour.size();
+
+    // 2-opt runs on the distances plus a fixed amount per penalty of the edge, added on the fly
+    EdgePenalties penalties(n);
+    double penaltyWeight = 0;
+
+    std::vector<int> best = tour;
+    double bestCost = cost;
+    long iterations = 0;
+
+    while (!finished(clock, options, iterations)) {
+        iterations++;
+        LocalSearch::twoOpt(matrix, penalties, tour, true);
+
+        cost = LocalSearch::tourCost(matrix, tour);
+        if (cost < bestCost - 1e-9) {
+            best = tour;
+            bestCost = cost;
+            trace.push_back({clock.elapsed(), bestCost});
+        }
+        if (penaltyWeight == 0) {
+            penaltyWeight = options.penaltyFactor * cost / n;
+            penalties.setWeight(penaltyWeight);
+        }
+
+        // penalize the edges of the local optimum with the highest utility d / (1 + penalty)
+        double maxUtility = -1;
+        std::vector<std::pair<int, int>> chosen;
+        for (int k = 0; k < n; k++) {
+            int u = std::min(tour[k], tour[(k + 1) % n]), v = std::max(tour[k], tour[(k + 1) % n]);
+            double utility = matrix.at(u, v) / (1 + penalties.count(u, v));
+            if (utility > maxUtility + 1e-9) {
+                maxUtility = utility;
+                chosen.clear();
+            }
+            if (utility >= maxUtility - 1e-9) chosen.emplace_back(u, v);
+        }
+        for (auto &e : chosen) penalties.add(e.first, e.second);
+    }
+
+    tour = best;
+    return bestCost;
+}
+
+double Metaheuristic::iteratedLocalSearch(const DistanceMatrix &matrix, std::vector<int> &tour, double cost,
+                                          const MetaheuristicOptions &options, std::vector<CostSample> &trace) {
+    Clock clock;
+    int n = (int) tour.size();
+    std::mt19937_64 rng(options.seed);
+    std::uniform_int_distribution<int> length(1, 3);
+    const int kicks = 3;
+
+    LocalSearch::twoOptOrOpt(matrix, tour, cost, true);
+    std::vector<int> best = tour;
+    double bestCost = cost;
+    if (bestCost < trace.back().cost) trace.push_back({clock.elapsed(), bestCost});
+
+    long iterations = 0;
+    std::vector<int> candidate, segment;
+    while (!finished(clock, options, iterations)) {
+        iterations++;
+        candidate = best;
+
+        // kick: move a few random segments of 1 to 3 vertices to random positions
+        for (int k = 0; k < kicks; k++) {
+            int len = length(rng);
+            int s = std::uniform_int_distribution<int>(1, n - len)(rng);
+            segment.assign(candidate.begin() + s, candidate.begin() + s + len);
+            candidate.erase(candidate.begin() + s, candidate.begin() + s + len);
+            int position = std::uniform_int_distribution<int>(1, n - len)(rng);
+            if (rng() & 1) std::reverse(segment.begin(), segment.end());
+            candidate.insert(candidate.begin() + position, segment.begin(), segment.end());
+        }
+
+        double candidateCost = LocalSearch::tourCost(matrix, candidate);
+        LocalSearch::twoOptOrOpt(matrix, candidate, candidateCost, true);
+        if (candidateCost < bestCost - 1e-9) {
+            best.swap(candidate);
+            bestCost = candidateCost;
+            trace.push_back({clock.elapsed(), bestCost});
+        }
+    }
+
+    tour = best;
+    return LocalSearch::tourCost(matrix, tour);
+}
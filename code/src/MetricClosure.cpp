@@ -0,0 +1,162 @@
+#include "../headers/MetricClosure.h"
+#include "../headers/Graph.h"
+#include "../headers/MutablePriorityQueue.h"
+#include "../headers/ThreadPool.h"
+#include <algorithm>
+
+const int MetricClosure::floydWarshallLimit;
+
+namespace {
+    // Dijkstra label of one vertex, as required by MutablePriorityQueue
+    struct Label {
+        double dist;
+        int id;
+        int queueIndex = 0;
+
+        bool operator<(const Label &other) const { return dist < other.dist; }
+    };
+}
+
+MetricClosure::MetricClosure(Graph &graph, unsigned threads): distances(graph.getNumVertex()) {
+    int n = graph.getNumVertex();
+    firstHop.assign((size_t) n * n, -1);
+    for (int u = 0; u < n; u++) firstHop[(size_t) u * n + u] = u;
+
+    // adjacency in compressed rows, so each Dijkstra only walks existing edges
+    std::vector<int> offsets(n + 1, 0), targets;
+    std::vector<double> weights;
+    for (auto v : graph.getVertexSet()) {
+        for (auto e : v->adj) {
+            if (e == nullptr) continue;
+            int u = v->getId(), w = e->getDest()->getId();
+            targets.push_back(w);
+            weights.push_back(e->getDistance());
+            if (e->getDistance() < distances.at(u, w)) {
+                distances.set(u, w, e->getDistance());
+                firstHop[(size_t) u * n + w] = w;
+            }
+        }
+        offsets[v->getId() + 1] = (int) targets.size();
+    }
+
+    if (n <= floydWarshallLimit) floydWarshall(threads);
+    else dijkstra(offsets, targets, weights, threads);
+}
+
+void MetricClosure::floydWarshall(unsigned threads) {
+    int n = size();
+    ThreadPool pool(threads, 0);
+    int block = std::max(1, n / (int) (4 * pool.size()));
+
+    // row k and column k do not change during round k, so the rows can be relaxed in parallel
+    for (int k = 0; k < n; k++) {
+        const double* through = distances.row(k);
+        for (int begin = 0; begin < n; begin += block) {
+            int end = std::min(n, begin + block);
+            pool.submit([this, n, k, through, begin, end]() {
+                for (int i = begin; i < end; i++) {
+                    double toK = distances.at(i, k);
+                    if (toK == DistanceMatrix::unknown() || i == k) continue;
+                    for (int j = 0; j < n; j++) {
+                        double candidate = toK + through[j];
+                        if (candidate < distances.at(i, j)) {
+                            distances.set(i, j, candidate);
+                            firstHop[(size_t) i * n + j] = firstHop[(size_t) i * n + k];
+                        }
+                    }
+                }
+            });
+        }
+        pool.wait();
+    }
+}
+
+void MetricClosure::dijkstra(const std::vector<int> &offsets, const std::vector<int> &targets,
+                             const std::vector<double> &weights, unsigned threads) {
+    int n = size();
+    ThreadPool pool(threads, 0);
+    const int block = 16;
+
+    for (int begin = 0; begin < n; begin += block) {
+        int end = std::min(n, begin + block);
+        pool.submit([this, n, &offsets, &targets, &weights, begin, end]() {
+            std::vector<Label> labels(n);
+            std::vector<int> previous(n), order;
+            order.reserve(n);
+
+            for (int source = begin; source < end; source++) {
+                for (int v = 0; v < n; v++) {
+                    labels[v].dist = DistanceMatrix::unknown();
+                    labels[v].id = v;
+                    labels[v].queueIndex = 0;
+                    previous[v] = -1;
+                }
+                order.clear();
+
+                MutablePriorityQueue<Label> queue;
+                labels[source].dist = 0;
+                queue.insert(&labels[source]);
+                while (!queue.empty()) {
+                    Label* u = queue.extractMin();
+                    order.push_back(u->id);
+                    for (int i = offsets[u->id]; i < offsets[u->id + 1]; i++) {
+                        Label &w = labels[targets[i]];
+                        double candidate = u->dist + weights[i];
+                        if (candidate >= w.dist) continue;
+                        bool queued = w.dist != DistanceMatrix::unknown();
+                        w.dist = candidate;
+                        previous[w.id] = u->id;
+                        if (queued) queue.decreaseKey(&w);
+                        else queue.insert(&w);
+                    }
+                }
+
+                // vertices come out in order of distance, so the first hop of the previous one is already known
+                int* hops = firstHop.data() + (size_t) source * n;
+                for (int v : order) {
+                    distances.set(source, v, labels[v].dist);
+                    if (v == source) continue;
+                    hops[v] = previous[v] == source ? v : hops[previous[v]];
+                }
+            }
+        });
+    }
+    pool.wait();
+}
+
+std::vector<int> MetricClosure::expand(const std::vector<int> &tour) const {
+    std::vector<int> walk;
+    if (tour.empty()) return walk;
+    int n = size();
+
+    walk.push_back(tour[0]);
+    for (size_t i = 0; i < tour.size(); i++) {
+        int target = tour[(i + 1) % tour.size()];
+        int at = tour[i];
+        while (at != target) {
+            at = firstHop[(size_t) at * n + target];
+            if (at == -1) return {};
+            walk.push_back(at);
+        }
+    }
+    return walk;
+}
+
+void MetricClosure::toGraph(const Graph &source, Graph &out) const {
+    int n = size();
+    std::vector<Vertex*> vertices = source.getVertexSet();
+    for (int u = 0; u < n; u++) {
+        Vertex* v = out.addVertex(u);
+        Coords* coords = vertices[u]->getCoords();
+        if (coords != nullptr) v->setCoords(coords->longitude, coords->latitude);
+    }
+    for (int u = 0; u < n; u++) {
+        for (int v = u + 1; v < n; v++) {
+            if (distances.known(u, v)) out.addBidirectionalEdge(out.findVertex(u), out.findVertex(v), distances.at(u, v));
+        }
+    }
+}
+
+size_t MetricClosure::memoryBytes() const {
+    return distances.memoryBytes() + firstHop.capacity() * sizeof(int);
+}
@@ -0,0 +1,121 @@
+#include "../headers/Numa.h"
+#include "../headers/ThreadPool.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <mutex>
+#include <sched.h>
+#include <unistd.h>
+
+namespace {
+    std::vector<int> allowedCpus() {
+        std::vector<int> res;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &set)) res.push_back(cpu);
+            }
+        }
+        if (res.empty()) res.push_back(0);
+        return res;
+    }
+
+    std::vector<NumaNode> readNodes() {
+        std::vector<int> allowed = allowedCpus();
+        std::vector<NumaNode> res;
+
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string list;
+        if (online && std::getline(online, list)) {
+            for (int id : Topology::parseCpuList(list)) {
+                std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+                std::string cpus;
+                if (!cpulist || !std::getline(cpulist, cpus)) continue;
+
+                NumaNode node{id, {}};
+                for (int cpu : Topology::parseCpuList(cpus)) {
+                    if (std::binary_search(allowed.begin(), allowed.end(), cpu)) node.cpus.push_back(cpu);
+                }
+                if (!node.cpus.empty()) res.push_back(node);
+            }
+        }
+        if (res.empty()) res.push_back({0, allowed});
+        return res;
+    }
+}
+
+const std::vector<NumaNode> &Topology::nodes() {
+    static const std::vector<NumaNode> nodes = readNodes();
+    return nodes;
+}
+
+int Topology::nodeOfCpu(int cpu) {
+    for (auto &node : nodes()) {
+        if (std::find(node.cpus.begin(), node.cpus.end(), cpu) != node.cpus.end()) return node.id;
+    }
+    return 0;
+}
+
+int Topology::currentCpu() {
+    return sched_getcpu();
+}
+
+std::vector<int> Topology::parseCpuList(const std::string &list) {
+    std::vector<int> res;
+    std::stringstream ss(list);
+    for (std::string range; std::getline(ss, range, ',');) {
+        if (range.empty()) continue;
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) res.push_back(cpu);
+        } catch (const std::exception&) {
+            continue;
+        }
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+MatrixReplicas::MatrixReplicas(std::shared_ptr<const DistanceMatrix> matrix, ThreadPool &pool, bool replicate) {
+    int maxNode = 0;
+    for (auto &node : Topology::nodes()) maxNode = std::max(maxNode, node.id);
+    replicaOfNode.assign(maxNode + 1, -1);
+
+    if (!replicate || Topology::nodes().size() == 1) {
+        replicas.push_back(matrix);
+        std::fill(replicaOfNode.begin(), replicaOfNode.end(), 0);
+        return;
+    }
+
+    // the first worker of each node copies the matrix, so the copy is first touched on that node; the original,
+    // filled by workers of every node, is spread over all of them and is not one of the replicas
+    std::mutex mutex;
+    std::vector<bool> claimed(maxNode + 1, false);
+    pool.forEachWorker([&](unsigned worker) {
+        int node = pool.nodeOf(worker);
+        if (node < 0 || node > maxNode) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (claimed[node]) return;
+            claimed[node] = true;
+        }
+        auto copy = std::make_shared<const DistanceMatrix>(*matrix);
+        std::lock_guard<std::mutex> lock(mutex);
+        replicaOfNode[node] = (int) replicas.size();
+        replicas.push_back(copy);
+    });
+    // without pinned workers there is no node to copy for
+    if (replicas.empty()) replicas.push_back(matrix);
+    for (int &replica : replicaOfNode) {
+        if (replica == -1) replica = 0;
+    }
+}
+
+std::shared_ptr<const DistanceMatrix> MatrixReplicas::local() const {
+    int node = Topology::nodeOfCpu(Topology::currentCpu());
+    if (node < 0 || node >= (int) replicaOfNode.size()) return replicas.front();
+    return replicas[replicaOfNode[node]];
+}
@@ -1,104 +1,329 @@
 #include "../headers/Printer.h"
+#include "../headers/CompactGraph.h"
 #include <chrono>
 
+const int Printer::closureVertexLimit;
+
 Printer::Printer() = default;
 
 Printer::Printer(const std::string& edgesPath) {
-    std::ifstream edgesIn(edgesPath);
-    Reader::readEdges(edgesIn, graph);
+    std::string nodesPath;
     if(edgesPath.find("real_graphs") != std::string::npos) {
-        std::string nodesPath = edgesPath;
-        size_t pos = nodesPath.find("edges");
-        if (pos != std::string::npos) {
-            nodesPath.replace(pos, 5, "nodes");
-            std::ifstream nodesIn(nodesPath);
-            Reader::readNodes(nodesIn, graph);
-        }
+        size_t pos = edgesPath.find("edges");
+        if (pos != std::string::npos) nodesPath = std::string(edgesPath).replace(pos, 5, "nodes");
+    }
+    loading = GraphLoader(edgesPath, nodesPath);
+}
+
+Printer::Printer(const std::string& edgesPath, const std::string& nodesPath) : loading(edgesPath, nodesPath) {}
+
+bool Printer::isLoading() const {
+    return loading.pending() && !loading.ready();
+}
+
+void Printer::waitForGraph() {
+    if (!loading.pending()) return;
+    if (!loading.ready()) std::cout << "Waiting for the graph to finish loading..." << std::endl;
+
+    LoadedGraph loaded = loading.take();
+    graph = std::move(loaded.graph);
+    std::cout << "Graph loaded in " << (long) loaded.times.totalMs << " milliseconds (edges "
+              << (long) loaded.times.edgesMs << " ms";
+    if (loaded.times.nodesMs > 0)
+        std::cout << ", nodes and geometry " << (long) loaded.times.nodesMs << " ms alongside";
+    std::cout << ")" << std::endl << std::endl;
+}
+
+void Printer::setShortestPaths(bool enabled) {
+    waitForGraph();
+    lowerBound = LowerBound();
+    closureGraph = Graph();
+    closure = nullptr;
+    if (!enabled) return;
+
+    // distances and first hops, then the complete graph over them
+    size_t n = graph.getNumVertex();
+    size_t bytes = n * n * (sizeof(double) + sizeof(int)) + n * (n - 1) * (sizeof(Edge) + sizeof(Edge*));
+    if (MemoryBudget::limit() == 0 && n > (size_t) closureVertexLimit) {
+        std::cout << "Shortest paths are limited to " << closureVertexLimit << " nodes without a memory budget (they"
+                  << " would need " << MemoryBudget::format(bytes) << "); set one with --memory-budget." << std::endl;
+        return;
+    }
+    if (!admit(bytes, "the shortest paths")) return;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    closure = graph.metricClosure();
+    closure->toGraph(graph, closureGraph);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::cout << "Shortest paths between " << closure->size() << " vertices computed in " << duration
+              << " milliseconds (" << closure->memoryBytes() / (1024 * 1024) << " MB)" << std::endl;
+}
+
+bool Printer::renumber(VertexOrder order) {
+    waitForGraph();
+    bool shortestPaths = usesShortestPaths();
+    setShortestPaths(false);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool done = graph.renumber(order);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    if (!done) std::cout << "The Hilbert order needs the coordinates of every node." << std::endl;
+    else {
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        std::cout << "Vertices renumbered in " << duration << " milliseconds" << std::endl;
+    }
+    if (shortestPaths) setShortestPaths(true);
+    return done;
+}
+
+bool Printer::usesShortestPaths() const {
+    return closure != nullptr;
+}
+
+bool Printer::precheck(bool edgesOnly) {
+    if (active().tourPossible(edgesOnly)) return true;
+
+    const Connectivity& connectivity = active().connectivity();
+    std::cout << "No tour over the edges: " << connectivity.reason() << "." << std::endl;
+    if (closure != nullptr || connectivity.components() != 1 || active().getNumVertex() < 3) return false;
+
+    // every pair of a connected graph is joined by a shortest path, so the closure always has a tour
+    std::cout << "Switching to shortest-path distances." << std::endl;
+    setShortestPaths(true);
+    return usesShortestPaths();
+}
+
+Graph& Printer::active() {
+    return closure != nullptr ? closureGraph : graph;
+}
+
+void Printer::printRoute(const std::vector<Vertex*>& path) {
+    if (closure == nullptr || path.empty()) return;
+
+    std::vector<int> tour;
+    for (auto v : path) tour.push_back(v->getId());
+    std::vector<int> walk = closure->expand(tour);
+    if (walk.empty()) {
+        std::cout << "Route over real edges: none (some stops are not connected)" << std::endl;
+        return;
     }
+
+    for (int& id : walk) id = graph.originalId(id);
+    writeIds("Route over real edges (" + std::to_string(walk.size() - 1) + " edges)", walk, false);
+}
+
+void Printer::setOutput(const std::string& path, OutputFormat format) {
+    outputPath = path;
+    outputFormat = format;
+    output.reset();
+}
+
+ResultWriter& Printer::writer() {
+    if (output == nullptr) output.reset(new ResultWriter(outputPath, outputFormat));
+    return *output;
+}
+
+void Printer::writePath(const std::vector<Vertex*>& path) {
+    std::vector<int> ids;
+    ids.reserve(path.size());
+    for (auto v : path) ids.push_back(graph.originalId(v->getId()));
+    writeIds("Path", ids, true);
+}
+
+void Printer::writeIds(const std::string& label, const std::vector<int>& ids, bool closed) {
+    ResultWriter& out = writer();
+    if (!out.isOpen()) {
+        std::cout << label << ": could not open " << outputPath << std::endl;
+        return;
+    }
+
+    size_t before = out.bytesWritten();
+    if (outputPath.empty()) std::cout << label << ": " << std::flush;
+    if (closed) out.writeTour(ids);
+    else out.writeWalk(ids);
+    out.flush();
+    if (!outputPath.empty())
+        std::cout << label << ": " << out.bytesWritten() - before << " bytes written to " << outputPath << std::endl;
+}
+
+bool Printer::admit(size_t bytes, const std::string& what) {
+    if (MemoryBudget::fits(bytes)) return true;
+
+    // the distance caches can always be rebuilt, so they go first
+    size_t freed = graph.evictDistances() + closureGraph.evictDistances();
+    lowerBound = LowerBound();
+    if (freed > 0) std::cout << "Dropped " << MemoryBudget::format(freed) << " of cached distances." << std::endl;
+    if (MemoryBudget::fits(bytes)) return true;
+
+    ProcessMemory memory = MemoryBudget::process();
+    std::cout << "Not enough memory for " << what << ": it needs " << MemoryBudget::format(bytes) << ", "
+              << MemoryBudget::format(memory.residentBytes) << " are in use and the budget is "
+              << MemoryBudget::format(MemoryBudget::limit()) << "." << std::endl;
+    return false;
+}
+
+void Printer::printMemory() {
+    ProcessMemory memory = MemoryBudget::process();
+    std::cout << "Memory: " << MemoryBudget::format(memory.residentBytes) << " resident || Peak: "
+              << MemoryBudget::format(memory.peakBytes);
+    if (MemoryBudget::limit() != 0) std::cout << " || Budget: " << MemoryBudget::format(MemoryBudget::limit());
+    std::cout << std::endl;
 }
 
 void Printer::printContent() {
+    waitForGraph();
+    ResultWriter& out = writer();
+    if (!out.isOpen()) {
+        std::cout << "Could not open " << outputPath << std::endl;
+        return;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t before = out.bytesWritten();
     int m = 0;
     for(auto v: graph.getVertexSet()){
         if(v->getCoords() != nullptr)
-            std::cout <<
-                      "NODE: " << v->getId() <<
-                      " || LATITUDE: " << v->getCoords()->latitude <<
-                      " || LONGITUDE: " << v->getCoords()->longitude <<
-                      std::endl;
+            out.writeNode(graph.originalId(v->getId()), v->getCoords()->latitude, v->getCoords()->longitude);
         for(auto e: v->adj) {
-            if (e == nullptr) {
-                std::cout << "SOURCE: null || DEST: null" << std::endl;
-                continue;
-            }
-            std::cout << "SOURCE: " << e->getOrig()->getId() << " || DEST: " << e->getDest()->getId() << " || DISTANCE: " << e->getDistance() << std::endl;
+            if (e == nullptr) continue;
+            out.writeEdge(graph.originalId(e->getOrig()->getId()), graph.originalId(e->getDest()->getId()),
+                          e->getDistance());
             m++;
         }
-
     }
-    std::cout << "Edges count: " << m << " || VERTICES: " << graph.getVertexSet().size()<<std::endl;
+    out.flush();
+    auto end = std::chrono::high_resolution_clock::now();
 
+    std::cout << "Edges count: " << m << " || VERTICES: " << graph.getVertexSet().size()<<std::endl;
+    const Connectivity& connectivity = graph.connectivity();
+    std::cout << "Components: " << connectivity.components() <<
+              " || Vertices with fewer than two edges: " << connectivity.leaves().size() <<
+              " || Bridges: " << connectivity.bridges().size() <<
+              " || Cut vertices: " << connectivity.cutVertices().size() << std::endl;
+    GraphMemory memory = graph.memory();
+    std::cout << "Graph memory: " << MemoryBudget::format(memory.total()) <<
+              " || Vertices: " << MemoryBudget::format(memory.vertices) <<
+              " || Adjacency: " << MemoryBudget::format(memory.adjacency) <<
+              " || Edges: " << MemoryBudget::format(memory.edges) <<
+              " || Coordinates: " << MemoryBudget::format(memory.coordinates) <<
+              " || Caches: " << MemoryBudget::format(memory.caches) << std::endl;
+    if (closure != nullptr)
+        std::cout << "Shortest-path graph memory: " << MemoryBudget::format(closureGraph.memory().total()) << std::endl;
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::cout << "Output: " << out.bytesWritten() - before << " bytes in " << duration << " milliseconds";
+    if (!outputPath.empty()) std::cout << " to " << outputPath;
+    std::cout << std::endl;
+    printMemory();
 }
 
 void Printer::printCostAndPath() {
+    waitForGraph();
+    if (!precheck(true)) return;
     std::vector<Vertex*> path;
 
+    // small graphs go to the exact solver sized at compile time, the others to the backtracking
+    int specialization = ExactSolvers::specializationFor(active().getNumVertex());
     auto start = std::chrono::high_resolution_clock::now();
 
-    double cost = graph.tspBT(path);
+    double cost = specialization != 0 ? active().tspExact(path) : active().tspBT(path);
 
     auto end = std::chrono::high_resolution_clock::now();
 
-    std::cout << "Path:";
-    for (auto v : path) {
-        std::cout << " " << v->getId();
+    if (cost == -1.0) {
+        std::cout << "The edges of the graph hold no tour." << std::endl;
+        return;
     }
-    std::cout << std::endl;
+
+    writePath(path);
     std::cout << "Cost: " << cost << std::endl;
+    printRoute(path);
 
     std::cout << std::endl;
+    if (specialization != 0) std::cout << "Exact solver for up to " << specialization << " vertices" << std::endl;
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
     std::cout << "Execution time: " << duration << " milliseconds" << std::endl;
+    printMemory();
 }
 
 void Printer::printCostAndPathTAH(bool isShippingGraph) {
+    waitForGraph();
+    if (!precheck(false)) return;
     std::vector<Vertex*> path;
-    auto firstVertex = graph.findVertex(0);
+    Graph &tahGraph = active();
+    auto firstVertex = tahGraph.findVertex(0);
     auto start = std::chrono::high_resolution_clock::now();
     double total_cost = 0.0;
-    auto mst = graph.mstPrim();
+    auto mst = tahGraph.mstPrim();
 
-    graph.addVectorPath();
+    tahGraph.addVectorPath();
 
-    for(auto v : graph.getVertexSet()){
+    for(auto v : tahGraph.getVertexSet()){
         v->setVisited(false);
     }
 
-    graph.dfs(firstVertex,path);
+    tahGraph.dfs(firstVertex,path);
 
-    if(isShippingGraph) total_cost = graph.calculateShipping(path);
-    else total_cost = graph.tspTriangular(path);
+    // over the metric closure every pair is joined by its shortest path, so no cost has to be made up
+    if(isShippingGraph && closure == nullptr) total_cost = tahGraph.calculateShipping(path);
+    else total_cost = tahGraph.tspTriangular(path);
 
     auto end = std::chrono::high_resolution_clock::now();
 
-    std:: cout << "Path: ";
-    for (auto v : path){
-        std::cout << v->getId() << " -> ";
-    }
-    std::cout << "0" << std::endl;
+    writePath(path);
     std::cout << "Cost: " << total_cost << std::endl;
+    printRoute(path);
 
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
     std::cout << "Execution time: " << duration << " milliseconds" << std::endl;
+    printMemory();
+    // the made-up shipping cost fills missing edges with an average, so a gap to it would mean nothing
+    if (!isShippingGraph || closure != nullptr) printGap(total_cost);
+}
+
+void Printer::printCostAndPathHeuristic(const HeuristicOptions& options) {
+    waitForGraph();
+    if (!precheck(false)) return;
+    bool usesMatrix = options.kernel != MoveKernel::GraphLookup || options.orOpt;
+    if (usesMatrix && !admit(active().distanceMatrixBytes(), "the distance matrix")) return;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<Vertex*> path;
 
+    double total_cost = active().tspHeuristic(path, options);
+
+    if(total_cost == -1.0) {
+        if (options.seed == TourSeed::SpaceFillingCurve && !active().hasCoords())
+            std::cout << "The space-filling curve needs the coordinates of every node.\n";
+        else
+            std::cout << "Our algorithm doesn't work with graphs not fully connected.\n";
+        return;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+
+    writePath(path);
+    std::cout << "Cost: " << total_cost << std::endl;
+    printRoute(path);
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::cout << "Execution time: " << duration << " milliseconds" << std::endl;
+    printMemory();
+    printGap(total_cost);
 }
 
-void Printer::printCostAndPathHeuristic() {
+void Printer::printCostAndPathMetaheuristic(const MetaheuristicOptions& options) {
+    waitForGraph();
+    if (!precheck(false)) return;
+    if (!admit(active().distanceMatrixBytes(), "the distance matrix")) return;
     auto start = std::chrono::high_resolution_clock::now();
 
     std::vector<Vertex*> path;
+    std::vector<CostSample> trace;
 
-    double total_cost = graph.tspHeuristic(path);
+    double total_cost = active().tspMetaheuristic(path, options, trace);
 
     if(total_cost == -1.0) {
         std::cout << "Our algorithm doesn't work with graphs not fully connected.\n";
@@ -107,13 +332,197 @@ void Printer::printCostAndPathHeuristic() {
 
     auto end = std::chrono::high_resolution_clock::now();
 
-    std:: cout << "Path: ";
-    for (auto v : path){
-        std::cout << v->getId() << " -> ";
-    }
-    std::cout << "0" << std::endl;
+    writePath(path);
     std::cout << "Cost: " << total_cost << std::endl;
+    printRoute(path);
+
+    // at most 20 samples, always including the first and the last one
+    std::cout << "Cost over time:" << std::endl;
+    size_t step = trace.size() / 20 + 1;
+    for (size_t i = 0; i < trace.size(); i++) {
+        if (i % step == 0 || i + 1 == trace.size())
+            std::cout << "  " << trace[i].ms << " ms: " << trace[i].cost << std::endl;
+    }
 
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
     std::cout << "Execution time: " << duration << " milliseconds" << std::endl;
-}
\ No newline at end of file
+    printMemory();
+    printGap(total_cost);
+}
+
+void Printer::printGap(double cost) {
+    LowerBound::Mode mode = LowerBound::mode(active());
+    if (mode == LowerBound::Mode::TooLarge) {
+        std::cout << "Lower bound: skipped (more than " << LowerBound::denseLimit << " nodes to bound over every pair)"
+                  << std::endl;
+        return;
+    }
+    if (mode == LowerBound::Mode::Matrix && !admit(active().distanceMatrixBytes(), "the lower bound")) return;
+    auto start = std::chrono::high_resolution_clock::now();
+    double bound = lowerBound.improve(active(), boundBudgetMs, cost);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    if (bound == -1.0) {
+        std::cout << "Lower bound: none (the graph has no Hamiltonian cycle)" << std::endl;
+        return;
+    }
+    std::cout << "Lower bound: " << bound;
+    if (lowerBound.isOptimal()) std::cout << " (optimal)";
+    if (bound > 0) std::cout << " || Gap: " << (cost - bound) / bound * 100 << "%";
+    std::cout << std::endl;
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::cout << "Lower bound time: " << duration << " milliseconds" << std::endl;
+}
+
+template <class W>
+void Printer::printCompactRow(const std::string& name, const CompactGraph<W>& compact) {
+    std::vector<int64_t> parent;
+    auto start = std::chrono::high_resolution_clock::now();
+    auto mstCost = compact.mstPrim(parent);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto mstTime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    std::vector<uint32_t> tour;
+    typename CompactGraph<W>::Sum tourCost;
+    start = std::chrono::high_resolution_clock::now();
+    bool found = compact.tspHeuristic(tour, tourCost);
+    end = std::chrono::high_resolution_clock::now();
+    auto tourTime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    std::cout << name << " || BYTES/EDGE: " << compact.bytesPerEdge() <<
+              " || MST: " << compact.toDouble(mstCost) << " (" << mstTime << " ms)" <<
+              " || HEURISTIC: ";
+    if (found) std::cout << compact.toDouble(tourCost) << " (" << tourTime << " ms)" << std::endl;
+    else std::cout << "no tour" << std::endl;
+}
+
+void Printer::printCompactStorage() {
+    waitForGraph();
+    size_t slots = 0, edges = 0;
+    double maxWeight = 0;
+    for (auto v : graph.getVertexSet()) {
+        slots += v->adj.capacity();
+        for (auto e : v->adj) {
+            if (e == nullptr) continue;
+            edges++;
+            maxWeight = std::max(maxWeight, e->getDistance());
+        }
+    }
+    if (edges == 0) {
+        std::cout << "The graph has no edges." << std::endl;
+        return;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    graph.mstPrim();
+    auto end = std::chrono::high_resolution_clock::now();
+    double mstCost = 0;
+    for (auto v : graph.getVertexSet()) {
+        if (v->getPath() != nullptr) mstCost += v->getDist();
+    }
+    auto mstTime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    std::vector<Vertex*> path;
+    start = std::chrono::high_resolution_clock::now();
+    double tourCost = graph.tspHeuristic(path);
+    end = std::chrono::high_resolution_clock::now();
+    auto tourTime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    // two Edge objects and their adjacency slots per undirected edge, without allocator overhead
+    double bytesPerEdge = (double) (edges * sizeof(Edge) + slots * sizeof(Edge*)) / (edges / 2.0);
+    std::cout << "Graph (double) || BYTES/EDGE: " << bytesPerEdge <<
+              " || MST: " << mstCost << " (" << mstTime << " ms)" <<
+              " || HEURISTIC: ";
+    if (tourCost != -1.0) std::cout << tourCost << " (" << tourTime << " ms)" << std::endl;
+    else std::cout << "no tour" << std::endl;
+
+    printCompactRow<float>("Compact (float32)", CompactGraph<float>::fromGraph(graph));
+    double scale = CompactGraph<uint32_t>::fitScale(maxWeight);
+    printCompactRow<uint32_t>("Compact (fixed, scale " + std::to_string(scale) + ")",
+                              CompactGraph<uint32_t>::fromGraph(graph, scale));
+}
+
+void Printer::printCompactFile(const std::string& edgesPath, const std::string& nodesPath) {
+    std::ifstream edges(edgesPath);
+    if (!edges.is_open()) {
+        std::cout << "Could not open " << edgesPath << std::endl;
+        return;
+    }
+    std::ifstream nodes;
+    if (!nodesPath.empty()) nodes.open(nodesPath);
+
+    CompactGraph<float> compact;
+    auto start = std::chrono::high_resolution_clock::now();
+    try {
+        Reader::readEdges(edges, compact);
+        if (nodes.is_open()) Reader::readNodes(nodes, compact);
+        compact.build();
+    } catch (const std::exception& e) {
+        std::cout << "Could not read the graph: " << e.what() << std::endl;
+        return;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto loadTime = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    std::cout << "Nodes: " << compact.getNumVertex() << " || Edges: " << compact.getNumEdges() << " || Storage: "
+              << MemoryBudget::format(compact.memoryBytes()) << " || Read in " << loadTime << " ms" << std::endl;
+    printCompactRow<float>("Compact (float32)", compact);
+    printMemory();
+}
+
+void Printer::printBatch(const std::string& subsetsPath, const BatchOptions& options) {
+    waitForGraph();
+    std::ifstream in(subsetsPath);
+    if (!in.is_open()) {
+        std::cout << "Could not open " << subsetsPath << std::endl;
+        return;
+    }
+    std::vector<std::vector<int>> subsets;
+    try {
+        subsets = Reader::readSubsets(in);
+    } catch (const std::exception&) {
+        std::cout << "Invalid vertex id in " << subsetsPath << std::endl;
+        return;
+    }
+    if (subsets.empty()) {
+        std::cout << "The file has no subsets." << std::endl;
+        return;
+    }
+
+    // the file uses the ids of the input files
+    for (auto& subset : subsets) {
+        for (int& id : subset) id = graph.internalId(id);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<BatchResult> results = BatchSolver::solve(active(), subsets, options);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    size_t solved = 0, exact = 0;
+    double totalCost = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        if (results[i].cost == -1.0) continue;
+        solved++;
+        totalCost += results[i].cost;
+        if ((int) subsets[i].size() <= std::min(options.exactThreshold, BatchSolver::maxExact)) exact++;
+    }
+
+    for (size_t i = 0; i < results.size() && i < 5; i++) {
+        std::cout << "Subset " << i << ": ";
+        if (results[i].cost == -1.0) {
+            std::cout << "no tour" << std::endl;
+            continue;
+        }
+        for (int id : results[i].tour) std::cout << graph.originalId(id) << " -> ";
+        std::cout << graph.originalId(results[i].tour[0]) << " || Cost: " << results[i].cost << std::endl;
+    }
+
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    std::cout << "Solved: " << solved << " of " << results.size() << " (" << exact << " exactly)" << std::endl;
+    std::cout << "Total cost: " << totalCost << std::endl;
+    std::cout << "Execution time: " << micros / 1000 << " milliseconds" << std::endl;
+    std::cout << "Throughput: " << (micros > 0 ? (double) results.size() * 1e6 / micros : 0.0)
+              << " instances per second" << std::endl;
+    printMemory();
+}
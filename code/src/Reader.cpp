@@ -1,11 +1,7 @@
 #include "../headers/Reader.h"
 
-void Reader::readEdges(std::ifstream &in, Graph& graph) {
-    std::string aux;
-    int srcID, destID;
-    double dist;
-    bool isFirst = true;
-
+bool Reader::readRecord(std::ifstream &in, bool &isFirst, std::string &first, std::string &second,
+                        std::string &third) {
     for (std::string line; getline(in, line);) {
         if (isFirst) {
             isFirst = false;
@@ -13,41 +9,58 @@ void Reader::readEdges(std::ifstream &in, Graph& graph) {
         }
 
         std::stringstream ss(line);
-        getline(ss, aux, ',');
-        srcID = std::stoi(aux);
-        getline(ss, aux, ',');
-        destID = std::stoi(aux);
-        getline(ss, aux, '\n');
-        dist = std::stod(aux);
+        getline(ss, first, ',');
+        getline(ss, second, ',');
+        getline(ss, third, '\n');
+        return true;
+    }
+    return false;
+}
 
-        Vertex* src = graph.addVertex(srcID);
-        Vertex* dest = graph.addVertex(destID);
+void Reader::readEdges(std::ifstream &in, Graph& graph) {
+    std::string src, dest, dist;
+    bool isFirst = true;
+
+    while (readRecord(in, isFirst, src, dest, dist)) {
+        Vertex* srcVertex = graph.addVertex(std::stoi(src));
+        Vertex* destVertex = graph.addVertex(std::stoi(dest));
 
-        graph.addBidirectionalEdge(src, dest, dist);
+        graph.addBidirectionalEdge(srcVertex, destVertex, std::stod(dist));
     }
 }
 
 
 void Reader::readNodes(std::ifstream &in, Graph& graph) {
-    std::string aux;
-    int id;
-    double longitude, latitude;
+    std::string id, longitude, latitude;
     bool isFirst = true;
 
+    while (readRecord(in, isFirst, id, longitude, latitude)) {
+        Vertex* vertex = graph.findVertex(std::stoi(id));
+        if (vertex != nullptr) vertex->setCoords(std::stod(longitude), std::stod(latitude));
+    }
+}
+
+std::vector<std::pair<int, Coords>> Reader::readCoords(std::ifstream &in) {
+    std::vector<std::pair<int, Coords>> coords;
+    std::string id, longitude, latitude;
+    bool isFirst = true;
+
+    while (readRecord(in, isFirst, id, longitude, latitude)) {
+        coords.push_back({std::stoi(id), {std::stod(longitude), std::stod(latitude)}});
+    }
+    return coords;
+}
+
+std::vector<std::vector<int>> Reader::readSubsets(std::ifstream &in) {
+    std::vector<std::vector<int>> subsets;
     for (std::string line; getline(in, line);) {
-        if (isFirst) {
-            isFirst = false;
-            if (line[0] != '0') continue;
-        }
+        if (line.empty() || line[0] == '#') continue;
+        for (char &c : line) if (c == ',') c = ' ';
 
         std::stringstream ss(line);
-        getline(ss, aux, ',');
-        id = std::stoi(aux);
-        getline(ss, aux, ',');
-        longitude = std::stod(aux);
-        getline(ss, aux, '\n');
-        latitude = std::stod(aux);
-
-        graph.getVertexSet()[id]->setCoords(longitude, latitude);
+        std::vector<int> subset;
+        for (std::string id; ss >> id;) subset.push_back(std::stoi(id));
+        if (!subset.empty()) subsets.push_back(subset);
     }
-}
\ No newline at end of file
+    return subsets;
+}
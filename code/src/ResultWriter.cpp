@@ -0,0 +1,133 @@
+#include "../headers/ResultWriter.h"
+#include <cstring>
+
+ResultWriter::ResultWriter(const std::string &path, OutputFormat format, size_t bufferBytes):
+        format(format), buffer(bufferBytes < 64 ? 64 : bufferBytes) {
+    if (path.empty()) out = stdout;
+    else {
+        out = fopen(path.c_str(), format == OutputFormat::Binary ? "wb" : "w");
+        ownsFile = true;
+    }
+}
+
+ResultWriter::~ResultWriter() {
+    flush();
+    if (ownsFile && out != nullptr) fclose(out);
+}
+
+void ResultWriter::writeTour(const std::vector<int> &ids) {
+    writeIds(ids, true);
+}
+
+void ResultWriter::writeWalk(const std::vector<int> &ids) {
+    writeIds(ids, false);
+}
+
+void ResultWriter::writeIds(const std::vector<int> &ids, bool closed) {
+    size_t count = ids.size() + (closed && !ids.empty() && format != OutputFormat::Binary ? 1 : 0);
+    switch (format) {
+        case OutputFormat::Plain:
+            for (size_t i = 0; i < count; i++) {
+                if (i > 0) append(" -> ", 4);
+                appendInt(ids[i % ids.size()]);
+            }
+            append("\n", 1);
+            break;
+        case OutputFormat::Csv:
+            append("position,id\n");
+            for (size_t i = 0; i < count; i++) {
+                appendInt((int64_t) i);
+                append(",", 1);
+                appendInt(ids[i % ids.size()]);
+                append("\n", 1);
+            }
+            break;
+        case OutputFormat::Binary:
+            appendRaw<uint32_t>((uint32_t) count);
+            for (size_t i = 0; i < count; i++) appendRaw<int32_t>(ids[i]);
+            break;
+    }
+    csvHeader = false;
+}
+
+void ResultWriter::writeNode(int id, double latitude, double longitude) {
+    if (format != OutputFormat::Plain) return;
+    append("NODE: ");
+    appendInt(id);
+    append(" || LATITUDE: ");
+    appendDouble(latitude);
+    append(" || LONGITUDE: ");
+    appendDouble(longitude);
+    append("\n", 1);
+}
+
+void ResultWriter::writeEdge(int source, int dest, double distance) {
+    switch (format) {
+        case OutputFormat::Plain:
+            append("SOURCE: ");
+            appendInt(source);
+            append(" || DEST: ");
+            appendInt(dest);
+            append(" || DISTANCE: ");
+            appendDouble(distance);
+            append("\n", 1);
+            break;
+        case OutputFormat::Csv:
+            if (!csvHeader) append("origem,destino,distancia\n");
+            csvHeader = true;
+            appendInt(source);
+            append(",", 1);
+            appendInt(dest);
+            append(",", 1);
+            appendDouble(distance);
+            append("\n", 1);
+            break;
+        case OutputFormat::Binary:
+            appendRaw<int32_t>(source);
+            appendRaw<int32_t>(dest);
+            appendRaw<double>(distance);
+            break;
+    }
+}
+
+void ResultWriter::flush() {
+    if (out == nullptr || used == 0) return;
+    fwrite(buffer.data(), 1, used, out);
+    fflush(out);
+    written += used;
+    used = 0;
+}
+
+void ResultWriter::append(const char *data, size_t size) {
+    if (out == nullptr) return;
+    if (used + size > buffer.size()) {
+        flush();
+        if (size > buffer.size()) {
+            fwrite(data, 1, size, out);
+            written += size;
+            return;
+        }
+    }
+    memcpy(buffer.data() + used, data, size);
+    used += size;
+}
+
+void ResultWriter::appendInt(int64_t value) {
+    char digits[24];
+    int length = 0;
+    bool negative = value < 0;
+    uint64_t magnitude = negative ? 0 - (uint64_t) value : (uint64_t) value;
+    do {
+        digits[sizeof(digits) - 1 - length++] = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (negative) digits[sizeof(digits) - 1 - length++] = '-';
+    append(digits + sizeof(digits) - length, length);
+}
+
+void ResultWriter::appendDouble(double value) {
+    // the same 6 significant digits std::cout uses by default in the plain format, 15 (exact for the input files) in csv
+    char text[32];
+    int length = snprintf(text, sizeof(text), format == OutputFormat::Plain ? "%g" : "%.15g", value);
+    append(text, (size_t) length);
+}
@@ -0,0 +1,345 @@
+#include "../headers/Server.h"
+#include "../headers/GraphLoader.h"
+#include "../headers/LocalSearch.h"
+#include "../headers/LowerBound.h"
+#include "../headers/Metaheuristic.h"
+#include "../headers/Reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    // number of latencies kept for the percentiles
+    const size_t latencyWindow = 10000;
+
+    class StdoutConnection : public Server::Connection {
+    public:
+        void send(const std::string &line) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::cout << line << '\n' << std::flush;
+        }
+    private:
+        std::mutex mutex;
+    };
+
+    /**
+     * Owns the socket of a client: it is only closed when the last queued solve holding the connection is done, so
+     * the descriptor cannot be reused by another client while results may still be sent to it.
+     */
+    class SocketConnection : public Server::Connection {
+    public:
+        explicit SocketConnection(int fd) : fd(fd) {}
+        ~SocketConnection() override {
+            close(fd);
+        }
+        void send(const std::string &line) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::string data = line + '\n';
+            size_t sent = 0;
+            while (sent < data.size()) {
+                ssize_t written = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (written <= 0) return;
+                sent += (size_t) written;
+            }
+        }
+    private:
+        int fd;
+        std::mutex mutex;
+    };
+
+    std::vector<std::string> split(const std::string &line) {
+        std::vector<std::string> words;
+        std::istringstream in(line);
+        for (std::string word; in >> word;) words.push_back(word);
+        return words;
+    }
+
+    /**
+     * Runs one algorithm on a distance matrix, only reading it.
+     * @return The cost of the tour (or the bound), -1.0 if there is none
+     */
+    double runAlgorithm(const DistanceMatrix &matrix, const std::string &algorithm, long budgetMs,
+                        unsigned long seed, std::vector<int> &tour) {
+        double cost = LocalSearch::nearestNeighbour(matrix, tour);
+        if (cost == -1.0 || algorithm == "nn") return cost;
+        if (algorithm == "2opt") {
+            LocalSearch::twoOpt(matrix, tour, cost, true);
+            return cost;
+        }
+        if (algorithm == "oropt") {
+            LocalSearch::twoOptOrOpt(matrix, tour, cost, true);
+            return cost;
+        }
+        if (algorithm == "bound") {
+            LocalSearch::twoOpt(matrix, tour, cost, true);
+            LowerBound bound;
+            tour.clear();
+            return bound.improve(matrix, budgetMs, cost);
+        }
+
+        MetaheuristicOptions options;
+        options.timeBudgetMs = budgetMs;
+        options.seed = seed;
+        if (algorithm == "gls") options.kind = MetaheuristicKind::GuidedLocalSearch;
+        else if (algorithm == "ils") options.kind = MetaheuristicKind::IteratedLocalSearch;
+        LocalSearch::twoOpt(matrix, tour, cost, true);
+        std::vector<CostSample> trace;
+        return Metaheuristic::run(matrix, tour, cost, options, trace);
+    }
+}
+
+Server::Server(const ServerOptions &options)
+        : options(options), pool(options.threads, options.queueCapacity, options.pinning),
+          started(std::chrono::steady_clock::now()) {}
+
+int Server::run() {
+    return options.socketPath.empty() ? serveStdin() : serveSocket();
+}
+
+int Server::serveStdin() {
+    auto connection = std::make_shared<StdoutConnection>();
+    for (std::string line; !stopping && std::getline(std::cin, line);) {
+        if (!handle(line, connection)) break;
+    }
+    pool.wait();
+    return 0;
+}
+
+int Server::serveSocket() {
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (listenFd < 0 || options.socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Cannot create the socket " << options.socketPath << std::endl;
+        return 1;
+    }
+    std::strncpy(address.sun_path, options.socketPath.c_str(), sizeof(address.sun_path) - 1);
+    unlink(options.socketPath.c_str());
+    if (bind(listenFd, (sockaddr*) &address, sizeof(address)) < 0 || listen(listenFd, 64) < 0) {
+        std::cerr << "Cannot listen on " << options.socketPath << ": " << std::strerror(errno) << std::endl;
+        close(listenFd);
+        return 1;
+    }
+    std::cerr << "Listening on " << options.socketPath << " with " << pool.size() << " solver threads" << std::endl;
+
+    std::vector<std::thread> threads;
+    while (!stopping) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (stopping || errno != EINTR) break;
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            clients.insert(fd);
+        }
+        threads.emplace_back(&Server::serveClient, this, fd);
+    }
+
+    // wake up the clients still connected so their threads can end
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (int fd : clients) shutdown(fd, SHUT_RDWR);
+    }
+    for (auto &thread : threads) thread.join();
+    pool.wait();
+    close(listenFd);
+    unlink(options.socketPath.c_str());
+    return 0;
+}
+
+void Server::serveClient(int fd) {
+    auto connection = std::make_shared<SocketConnection>(fd);
+    std::string pending;
+    char buffer[4096];
+    bool open = true;
+    while (open && !stopping) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) break;
+        pending.append(buffer, (size_t) received);
+        size_t newline;
+        while (open && (newline = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            open = handle(line, connection);
+        }
+    }
+
+    // results of solves still queued fail to send from now on; the socket is closed with the last of them
+    shutdown(fd, SHUT_RDWR);
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    clients.erase(fd);
+}
+
+bool Server::handle(const std::string &line, const std::shared_ptr<Connection> &connection) {
+    std::vector<std::string> args = split(line);
+    if (args.empty()) return true;
+
+    const std::string &command = args[0];
+    if (command == "load") connection->send(load(args));
+    else if (command == "unload") connection->send(unload(args));
+    else if (command == "list") connection->send(list());
+    else if (command == "solve") connection->send(solve(args, connection));
+    else if (command == "stats") connection->send(stats());
+    else if (command == "quit") return false;
+    else if (command == "shutdown") {
+        stopping = true;
+        if (listenFd >= 0) shutdown(listenFd, SHUT_RDWR);
+        return false;
+    } else connection->send("ERROR unknown command " + command);
+    return true;
+}
+
+std::string Server::load(const std::vector<std::string> &args) {
+    if (args.size() < 3 || args.size() > 4) return "ERROR usage: load <name> <edges.csv> [nodes.csv]";
+
+    std::ifstream edgesIn(args[2]);
+    if (!edgesIn) return "ERROR cannot open " + args[2];
+    std::string nodesPath = args.size() == 4 ? args[3] : "";
+    if (!nodesPath.empty() && !std::ifstream(nodesPath)) return "ERROR cannot open " + nodesPath;
+    // loads run one at a time, so two of them cannot both be admitted for the same memory
+    std::lock_guard<std::mutex> loading(loadMutex);
+    Graph graph;
+    try {
+        graph = GraphLoader::load(args[2], nodesPath).graph;
+    } catch (const std::exception &e) {
+        return "ERROR malformed file: " + std::string(e.what());
+    }
+    if (graph.getNumVertex() == 0) return "ERROR empty graph";
+    size_t bytes = graph.distanceMatrixBytes() * (options.replicas ? Topology::nodes().size() : 1);
+    if (!MemoryBudget::fits(bytes))
+        return "ERROR memory budget: the distance matrix needs " + MemoryBudget::format(bytes);
+    // without a budget the daemon still must not outgrow the machine, which would take every loaded graph down
+    size_t available = MemoryBudget::available();
+    if (MemoryBudget::limit() == 0 && available != 0 && bytes > available) {
+        return "ERROR memory: the distance matrix needs " + MemoryBudget::format(bytes) + ", only " +
+               MemoryBudget::format(available) + " are available";
+    }
+
+    // a helper pool pinned like the solvers fills (and so places) the matrix, so that a load neither waits behind the
+    // queued solves nor holds them up
+    ThreadPool loader(pool.size(), 0, options.pinning);
+    graph.distanceMatrix(loader);
+    auto replicas = std::make_shared<const MatrixReplicas>(graph.sharedDistanceMatrix(), loader, options.replicas);
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry[args[1]] = replicas;
+    return "OK loaded " + args[1] + " vertices=" + std::to_string(replicas->size());
+}
+
+std::string Server::unload(const std::vector<std::string> &args) {
+    if (args.size() != 2) return "ERROR usage: unload <name>";
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (registry.erase(args[1]) == 0) return "ERROR no graph named " + args[1];
+    return "OK unloaded " + args[1];
+}
+
+std::string Server::list() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::string res = "OK";
+    for (auto &entry : registry) res += " " + entry.first + ":" + std::to_string(entry.second->size());
+    return res;
+}
+
+std::string Server::solve(const std::vector<std::string> &args, const std::shared_ptr<Connection> &connection) {
+    if (args.size() < 4) return "ERROR usage: solve <name> <algorithm> <budgetMs> [seed] [tour]";
+
+    const std::string &algorithm = args[2];
+    static const std::vector<std::string> algorithms = {"nn", "2opt", "oropt", "sa", "gls", "ils", "bound"};
+    if (std::find(algorithms.begin(), algorithms.end(), algorithm) == algorithms.end())
+        return "ERROR unknown algorithm " + algorithm;
+
+    long budgetMs;
+    unsigned long seed = 1;
+    bool withTour = false;
+    try {
+        budgetMs = std::stol(args[3]);
+        for (size_t i = 4; i < args.size(); i++) {
+            if (args[i] == "tour") withTour = true;
+            else seed = std::stoul(args[i]);
+        }
+    } catch (const std::exception &) {
+        return "ERROR invalid number";
+    }
+
+    std::shared_ptr<const MatrixReplicas> replicas;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto it = registry.find(args[1]);
+        if (it == registry.end()) return "ERROR no graph named " + args[1];
+        replicas = it->second;
+    }
+
+    long id = nextId++;
+    auto queued = std::chrono::steady_clock::now();
+    bool accepted = pool.submit([this, id, replicas, algorithm, budgetMs, seed, withTour, connection, queued]() {
+        std::vector<int> tour;
+        double cost = runAlgorithm(*replicas->local(), algorithm, budgetMs, seed, tour);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - queued).count();
+        recordLatency(ms);
+        completed++;
+
+        std::ostringstream out;
+        out << "RESULT " << id;
+        if (cost == -1.0) out << " ERROR no tour";
+        else {
+            out.precision(15);
+            out << " cost=" << cost;
+            out.precision(6);
+            out << " ms=" << ms;
+            if (withTour && !tour.empty()) {
+                out << " tour=";
+                for (size_t i = 0; i < tour.size(); i++) out << (i == 0 ? "" : ",") << tour[i];
+            }
+        }
+        connection->send(out.str());
+    });
+
+    if (!accepted) {
+        rejected++;
+        return "ERROR busy, queue is full";
+    }
+    return "QUEUED " + std::to_string(id);
+}
+
+void Server::recordLatency(double ms) {
+    std::lock_guard<std::mutex> lock(latencyMutex);
+    if (latencies.size() < latencyWindow) latencies.push_back(ms);
+    else latencies[latencyNext] = ms;
+    latencyNext = (latencyNext + 1) % latencyWindow;
+}
+
+std::string Server::stats() {
+    std::vector<double> sorted;
+    {
+        std::lock_guard<std::mutex> lock(latencyMutex);
+        sorted = latencies;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p) {
+        if (sorted.empty()) return 0.0;
+        return sorted[std::min(sorted.size() - 1, (size_t) (p * sorted.size()))];
+    };
+    double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::ostringstream out;
+    out << "STATS queue=" << pool.queueDepth() << " running=" << pool.running() << " threads=" << pool.size()
+        << " completed=" << completed << " rejected=" << rejected
+        << " p50_ms=" << percentile(0.50) << " p95_ms=" << percentile(0.95) << " p99_ms=" << percentile(0.99)
+        << " throughput_per_s=" << (uptime > 0 ? completed / uptime : 0);
+    ProcessMemory memory = MemoryBudget::process();
+    out << " rss_mb=" << (memory.residentBytes >> 20) << " peak_mb=" << (memory.peakBytes >> 20) << " workers=";
+    std::vector<WorkerStats> workers = pool.stats();
+    for (size_t i = 0; i < workers.size(); i++) {
+        out << (i == 0 ? "" : ",") << workers[i].cpu << ":" << workers[i].node << ":" << workers[i].tasks << ":"
+            << workers[i].utilization;
+    }
+    return out.str();
+}
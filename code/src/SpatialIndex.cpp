@@ -0,0 +1,166 @@
+#include "../headers/SpatialIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+    void project(const std::vector<Coords> &points, std::vector<double> &xs, std::vector<double> &ys) {
+        double sumLat = 0;
+        for (auto &p : points) sumLat += p.latitude;
+        double scale = std::cos((sumLat / points.size()) * M_PI / 180.0);
+
+        xs.resize(points.size());
+        ys.resize(points.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            xs[i] = points[i].longitude * scale;
+            ys[i] = points[i].latitude;
+        }
+    }
+
+    std::vector<Coords> coordsOf(const std::vector<Vertex*> &vertices) {
+        std::vector<Coords> points;
+        points.reserve(vertices.size());
+        for (auto v : vertices) points.push_back(*v->getCoords());
+        return points;
+    }
+}
+
+SpatialIndex::SpatialIndex() = default;
+
+SpatialIndex::SpatialIndex(const std::vector<Vertex*> &vertices): SpatialIndex(coordsOf(vertices)) {}
+
+SpatialIndex::SpatialIndex(const std::vector<Coords> &points) {
+    if (points.empty()) return;
+    project(points, xs, ys);
+
+    minX = *std::min_element(xs.begin(), xs.end());
+    minY = *std::min_element(ys.begin(), ys.end());
+    double width = *std::max_element(xs.begin(), xs.end()) - minX;
+    double height = *std::max_element(ys.begin(), ys.end()) - minY;
+
+    // about two points per cell
+    double area = std::max(width * height, 1e-12);
+    cellSize = std::sqrt(2.0 * area / points.size());
+    if (cellSize <= 0) cellSize = 1;
+    cols = std::max(1, (int) (width / cellSize) + 1);
+    rows = std::max(1, (int) (height / cellSize) + 1);
+
+    std::vector<int> cellOfItem(xs.size());
+    cellStart.assign((size_t) cols * rows + 1, 0);
+    for (size_t i = 0; i < xs.size(); i++) {
+        int cx, cy;
+        cellOfItem[i] = cellOf(xs[i], ys[i], cx, cy);
+        cellStart[cellOfItem[i] + 1]++;
+    }
+    for (size_t c = 1; c < cellStart.size(); c++) cellStart[c] += cellStart[c - 1];
+
+    cellItems.resize(xs.size());
+    std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < xs.size(); i++) cellItems[fill[cellOfItem[i]]++] = (int) i;
+}
+
+int SpatialIndex::cellOf(double x, double y, int &cx, int &cy) const {
+    cx = std::min(cols - 1, std::max(0, (int) ((x - minX) / cellSize)));
+    cy = std::min(rows - 1, std::max(0, (int) ((y - minY) / cellSize)));
+    return cy * cols + cx;
+}
+
+std::vector<int> SpatialIndex::nearest(int pos, int k) const {
+    std::vector<int> res;
+    if (k <= 0 || xs.size() < 2) return res;
+    k = std::min<int>(k, (int) xs.size() - 1);
+
+    double qx = xs[pos], qy = ys[pos];
+    int cx, cy;
+    cellOf(qx, qy, cx, cy);
+
+    // max-heap of the best k found so far
+    std::priority_queue<std::pair<double, int>> best;
+    int maxRing = std::max(cols, rows);
+
+    for (int r = 0; r <= maxRing; r++) {
+        // every cell outside the ring r square is at least r * cellSize away from the query
+        if ((int) best.size() == k) {
+            double bound = (r - 1) * cellSize;
+            if (bound > 0 && bound * bound > best.top().first) break;
+        }
+
+        for (int y = cy - r; y <= cy + r; y++) {
+            if (y < 0 || y >= rows) continue;
+            bool edgeRow = (y == cy - r || y == cy + r);
+            for (int x = cx - r; x <= cx + r; x += (edgeRow ? 1 : 2 * r)) {
+                if (x >= 0 && x < cols) {
+                    int c = y * cols + x;
+                    for (int i = cellStart[c]; i < cellStart[c + 1]; i++) {
+                        int other = cellItems[i];
+                        if (other == pos) continue;
+                        double dx = xs[other] - qx, dy = ys[other] - qy;
+                        double d = dx * dx + dy * dy;
+                        if ((int) best.size() < k) best.emplace(d, other);
+                        else if (d < best.top().first) {
+                            best.pop();
+                            best.emplace(d, other);
+                        }
+                    }
+                }
+                if (r == 0) break;
+            }
+        }
+    }
+
+    res.resize(best.size());
+    for (int i = (int) res.size() - 1; i >= 0; i--) {
+        res[i] = best.top().second;
+        best.pop();
+    }
+    return res;
+}
+
+uint64_t SpatialIndex::hilbertIndex(uint32_t x, uint32_t y, int order) {
+    uint64_t d = 0;
+    for (uint32_t s = 1u << (order - 1); s > 0; s >>= 1) {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += (uint64_t) s * s * ((3 * rx) ^ ry);
+        // rotate the quadrant so the curve stays continuous
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - (x & (s - 1));
+                y = s - 1 - (y & (s - 1));
+            }
+            std::swap(x, y);
+        }
+        x &= s - 1;
+        y &= s - 1;
+    }
+    return d;
+}
+
+std::vector<int> SpatialIndex::hilbertOrder(const std::vector<Vertex*> &vertices) {
+    return hilbertOrder(coordsOf(vertices));
+}
+
+std::vector<int> SpatialIndex::hilbertOrder(const std::vector<Coords> &points) {
+    const int order = 16;
+    std::vector<double> xs, ys;
+    project(points, xs, ys);
+
+    double minX = *std::min_element(xs.begin(), xs.end());
+    double minY = *std::min_element(ys.begin(), ys.end());
+    double span = std::max(*std::max_element(xs.begin(), xs.end()) - minX,
+                           *std::max_element(ys.begin(), ys.end()) - minY);
+    if (span <= 0) span = 1;
+    double cells = (double) ((1u << order) - 1);
+
+    std::vector<std::pair<uint64_t, int>> keyed(xs.size());
+    for (size_t i = 0; i < xs.size(); i++) {
+        auto x = (uint32_t) ((xs[i] - minX) / span * cells);
+        auto y = (uint32_t) ((ys[i] - minY) / span * cells);
+        keyed[i] = {hilbertIndex(x, y, order), (int) i};
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    std::vector<int> res(keyed.size());
+    for (size_t i = 0; i < keyed.size(); i++) res[i] = keyed[i].second;
+    return res;
+}
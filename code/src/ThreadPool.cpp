@@ -0,0 +1,189 @@
+#include "../headers/ThreadPool.h"
+#include "../headers/Numa.h"
+#include <algorithm>
+#include <atomic>
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+    std::atomic<Pinning> pinningForNewPools{Pinning::None};
+
+    /**
+     * CPUs for the workers, in the order they are handed out.
+     */
+    std::vector<int> cpuOrder(Pinning pinning) {
+        std::vector<int> res;
+        const std::vector<NumaNode> &nodes = Topology::nodes();
+        if (pinning == Pinning::Compact) {
+            for (auto &node : nodes) res.insert(res.end(), node.cpus.begin(), node.cpus.end());
+        } else if (pinning == Pinning::Spread) {
+            size_t largest = 0;
+            for (auto &node : nodes) largest = std::max(largest, node.cpus.size());
+            for (size_t i = 0; i < largest; i++) {
+                for (auto &node : nodes) {
+                    if (i < node.cpus.size()) res.push_back(node.cpus[i]);
+                }
+            }
+        }
+        return res;
+    }
+}
+
+ThreadPool::ThreadPool(unsigned threads, size_t capacity): ThreadPool(threads, capacity, defaultPinning()) {}
+
+ThreadPool::ThreadPool(unsigned threads, size_t capacity, Pinning pinning):
+        capacity(capacity), started(std::chrono::steady_clock::now()) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<int> order = cpuOrder(pinning);
+    cpus.assign(threads, -1);
+    for (unsigned i = 0; i < threads && !order.empty(); i++) cpus[i] = order[i % order.size()];
+    workerTasks.resize(threads);
+    taskCounts.assign(threads, 0);
+    busy.assign(threads, std::chrono::steady_clock::duration::zero());
+
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::work, this, i);
+        pin(i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (auto &worker : workers) worker.join();
+}
+
+void ThreadPool::setDefaultPinning(Pinning pinning) {
+    pinningForNewPools = pinning;
+}
+
+Pinning ThreadPool::defaultPinning() {
+    return pinningForNewPools;
+}
+
+bool ThreadPool::submit(std::function<void()> task) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (capacity != 0 && tasks.size() >= capacity) return false;
+        tasks.push_back(std::move(task));
+    }
+    available.notify_one();
+    return true;
+}
+
+void ThreadPool::submitTo(unsigned worker, std::function<void()> task) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        workerTasks[worker].push_back(std::move(task));
+        pendingWorkerTasks++;
+    }
+    // the worker may be any of the sleeping ones, so all are woken
+    available.notify_all();
+}
+
+void ThreadPool::forEachWorker(const std::function<void(unsigned)> &task) {
+    std::mutex doneMutex;
+    std::condition_variable doneChanged;
+    size_t left = workers.size();
+
+    for (unsigned i = 0; i < workers.size(); i++) {
+        submitTo(i, [&, i]() {
+            task(i);
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--left == 0) doneChanged.notify_all();
+        });
+    }
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneChanged.wait(lock, [&left] { return left == 0; });
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return tasks.empty() && pendingWorkerTasks == 0 && active == 0; });
+}
+
+size_t ThreadPool::queueDepth() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return tasks.size() + pendingWorkerTasks;
+}
+
+size_t ThreadPool::running() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return active;
+}
+
+unsigned ThreadPool::size() const {
+    return (unsigned) workers.size();
+}
+
+int ThreadPool::cpuOf(unsigned worker) const {
+    return cpus[worker];
+}
+
+int ThreadPool::nodeOf(unsigned worker) const {
+    return cpus[worker] == -1 ? -1 : Topology::nodeOfCpu(cpus[worker]);
+}
+
+std::vector<WorkerStats> ThreadPool::stats() {
+    std::unique_lock<std::mutex> lock(mutex);
+    double lifetimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    std::vector<WorkerStats> res;
+    for (unsigned i = 0; i < workers.size(); i++) {
+        double busyMs = std::chrono::duration<double, std::milli>(busy[i]).count();
+        res.push_back({cpus[i], nodeOf(i), taskCounts[i], busyMs, lifetimeMs > 0 ? busyMs / lifetimeMs : 0.0});
+    }
+    return res;
+}
+
+void ThreadPool::pin(unsigned index) {
+    if (cpus[index] == -1) return;
+
+    pthread_t thread = workers[index].native_handle();
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[index], &set);
+    bool pinned = pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+
+    // record what the kernel actually applied, so the stats never claim a pinning that failed
+    cpu_set_t applied;
+    CPU_ZERO(&applied);
+    if (!pinned || pthread_getaffinity_np(thread, sizeof(applied), &applied) != 0
+        || CPU_COUNT(&applied) != 1 || !CPU_ISSET(cpus[index], &applied)) {
+        cpus[index] = -1;
+    }
+}
+
+void ThreadPool::work(unsigned index) {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this, index] {
+                return stopping || !tasks.empty() || !workerTasks[index].empty();
+            });
+            if (!workerTasks[index].empty()) {
+                task = std::move(workerTasks[index].front());
+                workerTasks[index].pop_front();
+                pendingWorkerTasks--;
+            } else if (!tasks.empty()) {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            } else return;
+            active++;
+        }
+        auto start = std::chrono::steady_clock::now();
+        task();
+        auto end = std::chrono::steady_clock::now();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            active--;
+            taskCounts[index]++;
+            busy[index] += end - start;
+            if (tasks.empty() && pendingWorkerTasks == 0 && active == 0) idle.notify_all();
+        }
+    }
+}
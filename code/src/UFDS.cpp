@@ -0,0 +1,64 @@
+#include "../headers/UFDS.h"
+#include <utility>
+
+UFDS::UFDS(unsigned int N) {
+    path.resize(N);
+    rank.resize(N);
+    for (unsigned int i = 0; i < N; i++) {
+        path[i] = i;
+        rank[i] = 0;
+    }
+}
+
+unsigned int UFDS::findSet(unsigned int i) {
+    unsigned int root = i;
+    while (path[root] != root) root = path[root];
+    while (path[i] != root) {
+        unsigned int next = path[i];
+        path[i] = root;
+        i = next;
+    }
+    return root;
+}
+
+bool UFDS::isSameSet(unsigned int i, unsigned int j) {
+    return findSet(i) == findSet(j);
+}
+
+void UFDS::linkSets(unsigned int i, unsigned int j) {
+    unsigned int x = findSet(i);
+    unsigned int y = findSet(j);
+    if (x == y) return;
+    if (rank[x] > rank[y]) {
+        path[y] = x;
+    } else {
+        path[x] = y;
+        if (rank[x] == rank[y]) rank[y]++;
+    }
+}
+
+ConcurrentUFDS::ConcurrentUFDS(unsigned int N): path(N) {
+    for (unsigned int i = 0; i < N; i++) path[i].store(i, std::memory_order_relaxed);
+}
+
+unsigned int ConcurrentUFDS::findSet(unsigned int i) {
+    while (true) {
+        unsigned int next = path[i].load(std::memory_order_relaxed);
+        if (next == i) return i;
+        unsigned int after = path[next].load(std::memory_order_relaxed);
+        if (next != after) path[i].compare_exchange_weak(next, after, std::memory_order_relaxed);
+        i = after;
+    }
+}
+
+void ConcurrentUFDS::linkSets(unsigned int i, unsigned int j) {
+    while (true) {
+        i = findSet(i);
+        j = findSet(j);
+        if (i == j) return;
+        if (i < j) std::swap(i, j);
+        // i is still a root only if no other thread linked it in the meantime
+        unsigned int expected = i;
+        if (path[i].compare_exchange_strong(expected, j, std::memory_order_relaxed)) return;
+    }
+}
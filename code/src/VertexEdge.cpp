@@ -17,6 +17,11 @@ void Vertex::add(std::vector<Edge*> &vec, Edge* edge) {
 Edge * Vertex::addEdge(Vertex *d, double w) {
     auto newEdge = new Edge(this, d, w);
     add(adj, newEdge);
+    // a repeated edge keeps the first one, which owns the slot
+    if (adj[d->getId()] != newEdge) {
+        delete newEdge;
+        return adj[d->getId()];
+    }
     return newEdge;
 }
 
@@ -28,6 +33,10 @@ int Vertex::getId() const {
     return this->id;
 }
 
+void Vertex::setId(int id) {
+    this->id = id;
+}
+
 
 bool Vertex::isVisited() const {
     return this->visited;
@@ -62,8 +71,8 @@ void Vertex::setPath(Edge *path) {
 }
 
 void Vertex::setCoords(double longitude, double latitude) {
-    Coords* newCoords = new Coords{longitude, latitude};
-    coords = newCoords;
+    if (coords != nullptr) *coords = {longitude, latitude};
+    else coords = new Coords{longitude, latitude};
 }
 
 /********************** Edge  ****************************/
@@ -0,0 +1,189 @@
+#include "code/headers/Graph.h"
+#include "code/headers/SpatialIndex.h"
+#include "code/headers/UFDS.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+
+namespace {
+    struct Options {
+        std::string outDir;
+        long nodes = 1000;
+        unsigned long seed = 1;
+        std::string layout = "uniform";
+        int clusters = 20;
+        std::string edges = "knn";
+        int k = 10;
+    };
+
+    // complete graphs beyond this size do not fit in memory once loaded
+    const long maxCompleteNodes = 50000;
+    const long minNodes = 1000, maxNodes = 1000000;
+
+    void usage() {
+        std::cout << "Usage: feup_da_proj2_generator <output directory> [options]" << std::endl;
+        std::cout << "  --nodes N         number of vertices, 1000 to 1000000 (default 1000)" << std::endl;
+        std::cout << "  --seed S          random seed (default 1)" << std::endl;
+        std::cout << "  --layout L        uniform | clustered (default uniform)" << std::endl;
+        std::cout << "  --clusters C      number of clusters for the clustered layout (default 20)" << std::endl;
+        std::cout << "  --edges E         complete | knn (default knn)" << std::endl;
+        std::cout << "  --k K             neighbours per vertex for knn edges (default 10)" << std::endl;
+        std::cout << "Writes edges.csv and nodes.csv in the format read by Reader::readEdges/readNodes." << std::endl;
+    }
+
+    bool parse(int argc, char* argv[], Options &options) {
+        if (argc < 2 || argv[1][0] == '-') return false;
+        options.outDir = argv[1];
+        for (int i = 2; i + 1 < argc; i += 2) {
+            std::string flag = argv[i], value = argv[i + 1];
+            if (flag == "--nodes") options.nodes = std::stol(value);
+            else if (flag == "--seed") options.seed = std::stoul(value);
+            else if (flag == "--layout") options.layout = value;
+            else if (flag == "--clusters") options.clusters = std::stoi(value);
+            else if (flag == "--edges") options.edges = value;
+            else if (flag == "--k") options.k = std::stoi(value);
+            else return false;
+        }
+        if (argc % 2 != 0) return false;
+        if (options.layout != "uniform" && options.layout != "clustered") return false;
+        if (options.edges != "complete" && options.edges != "knn") return false;
+        return options.nodes >= minNodes && options.nodes <= maxNodes && options.k >= 1 && options.clusters >= 1;
+    }
+
+    void generateCoords(const Options &options, Graph &graph) {
+        // bounding box around mainland Portugal, like the real graphs
+        const double minLon = -9.5, maxLon = -6.2, minLat = 37.0, maxLat = 42.1;
+        std::mt19937_64 rng(options.seed);
+        std::uniform_real_distribution<double> lon(minLon, maxLon), lat(minLat, maxLat);
+
+        std::vector<Coords> centers;
+        std::normal_distribution<double> spread(0.0, 0.05 * (maxLat - minLat) / std::sqrt(options.clusters));
+        std::uniform_int_distribution<int> pick(0, options.clusters - 1);
+        if (options.layout == "clustered") {
+            for (int c = 0; c < options.clusters; c++) centers.push_back({lon(rng), lat(rng)});
+        }
+
+        for (long id = 0; id < options.nodes; id++) {
+            double longitude, latitude;
+            if (centers.empty()) {
+                longitude = lon(rng);
+                latitude = lat(rng);
+            } else {
+                const Coords &c = centers[pick(rng)];
+                longitude = std::min(maxLon, std::max(minLon, c.longitude + spread(rng)));
+                latitude = std::min(maxLat, std::max(minLat, c.latitude + spread(rng)));
+            }
+            graph.addVertex((int) id)->setCoords(longitude, latitude);
+        }
+    }
+
+    /**
+     * @return False if the file could not be written
+     */
+    bool writeNodes(const std::string &path, Graph &graph) {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << "id,longitude,latitude\n";
+        char line[96];
+        for (auto v : graph.getVertexSet()) {
+            std::snprintf(line, sizeof(line), "%d,%.7f,%.7f\n", v->getId(), v->getCoords()->longitude,
+                          v->getCoords()->latitude);
+            out << line;
+        }
+        out.flush();
+        return out.good();
+    }
+
+    /**
+     * Writes the edges and counts the connected components they leave (always 1 for complete graphs).
+     * @return The number of edges written, -1 if the file could not be written
+     */
+    long writeEdges(const std::string &path, const Options &options, Graph &graph, long &components) {
+        std::ofstream out(path);
+        if (!out) return -1;
+        out << "origem,destino,distancia\n";
+        char line[96];
+        long count = 0;
+        auto vertices = graph.getVertexSet();
+        UFDS sets(vertices.size());
+        components = (long) vertices.size();
+        auto write = [&](Vertex* u, Vertex* v) {
+            std::snprintf(line, sizeof(line), "%d,%d,%.2f\n", u->getId(), v->getId(), graph.Haversine(u, v));
+            out << line;
+            count++;
+            if (!sets.isSameSet(u->getId(), v->getId())) {
+                sets.linkSets(u->getId(), v->getId());
+                components--;
+            }
+        };
+
+        if (options.edges == "complete") {
+            for (size_t i = 0; i < vertices.size(); i++)
+                for (size_t j = i + 1; j < vertices.size(); j++) write(vertices[i], vertices[j]);
+            out.flush();
+            return out.good() ? count : -1;
+        }
+
+        SpatialIndex index(vertices);
+        std::vector<std::vector<int>> neighbours(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            neighbours[i] = index.nearest((int) i, options.k);
+            std::sort(neighbours[i].begin(), neighbours[i].end());
+        }
+        for (size_t i = 0; i < vertices.size(); i++) {
+            for (int j : neighbours[i]) {
+                // write each undirected edge once, from its lower endpoint if both sides chose it
+                if (j < (int) i && std::binary_search(neighbours[j].begin(), neighbours[j].end(), (int) i)) continue;
+                write(vertices[i], vertices[j]);
+            }
+        }
+        out.flush();
+        return out.good() ? count : -1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+    if (options.edges == "complete" && options.nodes > maxCompleteNodes) {
+        std::cerr << "Complete graphs are limited to " << maxCompleteNodes << " nodes; use --edges knn." << std::endl;
+        return 1;
+    }
+    if (mkdir(options.outDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "Cannot create " << options.outDir << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    Graph graph;
+    generateCoords(options, graph);
+    std::string nodesPath = options.outDir + "/nodes.csv", edgesPath = options.outDir + "/edges.csv";
+    if (!writeNodes(nodesPath, graph)) {
+        std::cerr << "Cannot write " << nodesPath << std::endl;
+        return 1;
+    }
+    long components;
+    long edges = writeEdges(edgesPath, options, graph, components);
+    if (edges == -1) {
+        std::cerr << "Cannot write " << edgesPath << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote " << options.nodes << " nodes and " << edges << " edges (connected components: "
+              << components << ") to " << options.outDir << std::endl;
+    if (components > 1) {
+        std::cerr << "Warning: the graph is disconnected, so no tour uses only its edges; a larger --k joins more"
+                  << " neighbours." << std::endl;
+    }
+    return 0;
+}
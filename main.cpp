@@ -1,7 +1,41 @@
 #include "code/headers/Menu.h"
+#include "code/headers/Server.h"
 
+#include <cstring>
+
+namespace {
+    Pinning parsePinning(const char *name) {
+        if (std::strcmp(name, "compact") == 0) return Pinning::Compact;
+        if (std::strcmp(name, "spread") == 0) return Pinning::Spread;
+        return Pinning::None;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // a memory budget in MB applies to the menu and the server alike
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], "--memory-budget") == 0) MemoryBudget::setLimit(std::stoul(argv[i + 1]) << 20);
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "--server") == 0) {
+        ServerOptions options;
+        for (int i = 2; i < argc; i++) {
+            if (std::strcmp(argv[i], "--replicas") == 0) {
+                options.replicas = true;
+                continue;
+            }
+            if (i + 1 >= argc) break;
+            if (std::strcmp(argv[i], "--socket") == 0) options.socketPath = argv[i + 1];
+            else if (std::strcmp(argv[i], "--threads") == 0) options.threads = std::stoul(argv[i + 1]);
+            else if (std::strcmp(argv[i], "--queue") == 0) options.queueCapacity = std::stoul(argv[i + 1]);
+            else if (std::strcmp(argv[i], "--pin") == 0) options.pinning = parsePinning(argv[i + 1]);
+            i++;
+        }
+        ThreadPool::setDefaultPinning(options.pinning);
+        Server server(options);
+        return server.run();
+    }
 
-int main() {
     Menu menu;
     menu.run();
 }
\ No newline at end of file
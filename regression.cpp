@@ -0,0 +1,483 @@
+#include "code/headers/BatchSolver.h"
+#include "code/headers/ExactSolver.h"
+#include "code/headers/GraphLoader.h"
+#include "code/headers/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+
+namespace {
+    struct Options {
+        std::string dataDir = "../code/data";
+        std::string goldenPath;                 // empty for <dataDir>/regression/golden.csv
+        std::vector<std::pair<std::string, std::string>> extra;     // name, directory with edges.csv and nodes.csv
+        std::vector<std::string> only;          // algorithms to run, all if empty
+        bool record = false;
+        int repeat = 2;
+        unsigned threads = 4;
+        int maxVertices = 1000;
+        double tolerance = 1e-9;
+        double slowdown = 2.0;
+        double minMs = 20;
+        long iterations = 100;
+    };
+
+    struct Dataset {
+        std::string name;
+        std::string edgesPath;
+        std::string nodesPath;
+    };
+
+    /**
+     * Result of one algorithm on one dataset: what is compared between runs and stored in the golden file.
+     */
+    struct Run {
+        double cost = -1.0;
+        std::vector<int> tour;
+        double ms = 0;
+    };
+
+    struct Algorithm {
+        std::string name;
+        bool edgesOnly;     // the tour may only follow edges (the exact solvers)
+        int maxVertices;    // bigger graphs are skipped, 0 for --max-vertices
+        std::function<Run(Graph&, const Options&)> run;
+    };
+
+    struct Counts {
+        int passed = 0, failed = 0, skipped = 0;
+    };
+
+    void usage() {
+        std::cout << "Usage: feup_da_proj2_regression [options]" << std::endl;
+        std::cout << "  --data DIR            datasets directory (default ../code/data); missing datasets are skipped"
+                  << std::endl;
+        std::cout << "  --golden FILE         golden tours, costs and times (default DIR/regression/golden.csv)"
+                  << std::endl;
+        std::cout << "  --dataset NAME=DIR    also run on DIR/edges.csv and DIR/nodes.csv (feup_da_proj2_generator)"
+                  << std::endl;
+        std::cout << "  --algorithm A         only run A (repeatable): bt exact tah nn greedy sfc oropt sa gls ils"
+                  << " batch" << std::endl;
+        std::cout << "  --record              write the golden file from this run instead of checking against it"
+                  << std::endl;
+        std::cout << "  --repeat N            runs of each algorithm that must give identical results (default 2)"
+                  << std::endl;
+        std::cout << "  --threads T           threads of the parallel batch run compared with one thread (default 4)"
+                  << std::endl;
+        std::cout << "  --max-vertices N      largest graph for the heuristics and metaheuristics (default 1000)"
+                  << std::endl;
+        std::cout << "  --tolerance R         relative cost difference accepted against the golden file (default 1e-9)"
+                  << std::endl;
+        std::cout << "  --slowdown F          fail when slower than F times the stored time (default 2)" << std::endl;
+        std::cout << "  --min-ms M            stored times below M milliseconds are not judged (default 20)"
+                  << std::endl;
+        std::cout << "  --iterations N        local searches of the seeded metaheuristics, thousands of moves for sa"
+                  << " (default 100)" << std::endl;
+    }
+
+    bool parse(int argc, char* argv[], Options &options) {
+        for (int i = 1; i < argc; i++) {
+            std::string flag = argv[i];
+            if (flag == "--record") {
+                options.record = true;
+                continue;
+            }
+            if (i + 1 >= argc) return false;
+            std::string value = argv[++i];
+            try {
+                if (flag == "--data") options.dataDir = value;
+                else if (flag == "--golden") options.goldenPath = value;
+                else if (flag == "--algorithm") options.only.push_back(value);
+                else if (flag == "--repeat") options.repeat = std::max(1, std::stoi(value));
+                else if (flag == "--threads") options.threads = std::stoul(value);
+                else if (flag == "--max-vertices") options.maxVertices = std::stoi(value);
+                else if (flag == "--tolerance") options.tolerance = std::stod(value);
+                else if (flag == "--slowdown") options.slowdown = std::stod(value);
+                else if (flag == "--min-ms") options.minMs = std::stod(value);
+                else if (flag == "--iterations") options.iterations = std::stol(value);
+                else if (flag == "--dataset") {
+                    size_t eq = value.find('=');
+                    if (eq == std::string::npos) return false;
+                    options.extra.emplace_back(value.substr(0, eq), value.substr(eq + 1));
+                } else return false;
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        if (options.goldenPath.empty()) options.goldenPath = options.dataDir + "/regression/golden.csv";
+        return true;
+    }
+
+    bool exists(const std::string &path) {
+        struct stat info{};
+        return stat(path.c_str(), &info) == 0;
+    }
+
+    /**
+     * Creates the directories leading to a file, like mkdir -p on its directory.
+     */
+    void makeParents(const std::string &path) {
+        for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1))
+            mkdir(path.substr(0, slash).c_str(), 0755);
+    }
+
+    /**
+     * The datasets of the menu, then the ones given with --dataset.
+     */
+    std::vector<Dataset> datasets(const Options &options) {
+        std::vector<Dataset> res;
+        const std::string &data = options.dataDir;
+        for (std::string toy : {"shipping", "stadiums", "tourism"})
+            res.push_back({"toys/" + toy, data + "/toys_graph/" + toy + ".csv", ""});
+        for (int n : {25, 50, 75, 100, 200, 300, 400, 500, 600, 700, 800, 900}) {
+            std::string name = "edges_" + std::to_string(n);
+            res.push_back({"medium/" + name, data + "/medium_graphs/" + name + ".csv", ""});
+        }
+        for (int g = 1; g <= 3; g++) {
+            std::string dir = data + "/real_graphs/graph" + std::to_string(g);
+            res.push_back({"real/graph" + std::to_string(g), dir + "/edges.csv", dir + "/nodes.csv"});
+        }
+        for (auto &entry : options.extra)
+            res.push_back({entry.first, entry.second + "/edges.csv", entry.second + "/nodes.csv"});
+        return res;
+    }
+
+    std::vector<int> idsOf(const std::vector<Vertex*> &path) {
+        std::vector<int> ids;
+        for (auto v : path) ids.push_back(v->getId());
+        return ids;
+    }
+
+    Run heuristic(Graph &graph, TourSeed seed, MoveKernel kernel, bool orOpt) {
+        HeuristicOptions heuristicOptions;
+        heuristicOptions.seed = seed;
+        heuristicOptions.kernel = kernel;
+        heuristicOptions.orOpt = orOpt;
+        std::vector<Vertex*> path;
+        Run res;
+        res.cost = graph.tspHeuristic(path, heuristicOptions);
+        res.tour = idsOf(path);
+        return res;
+    }
+
+    Run metaheuristic(Graph &graph, MetaheuristicKind kind, const Options &options) {
+        MetaheuristicOptions metaOptions;
+        metaOptions.kind = kind;
+        metaOptions.seed = 1;
+        metaOptions.maxIterations = options.iterations;
+        // the iteration limit has to end the run, not the clock, for the result to be reproducible
+        metaOptions.timeBudgetMs = 3600 * 1000;
+        if (kind == MetaheuristicKind::SimulatedAnnealing) metaOptions.maxIterations *= 1000;
+        std::vector<Vertex*> path;
+        std::vector<CostSample> trace;
+        Run res;
+        res.cost = graph.tspMetaheuristic(path, metaOptions, trace);
+        res.tour = idsOf(path);
+        return res;
+    }
+
+    /**
+     * Triangular approximation as run by Printer::printCostAndPathTAH.
+     */
+    Run triangular(Graph &graph) {
+        for (auto v : graph.getVertexSet()) v->getDestVertexVector().clear();
+        graph.mstPrim();
+        graph.addVectorPath();
+        for (auto v : graph.getVertexSet()) v->setVisited(false);
+        std::vector<Vertex*> path;
+        graph.dfs(graph.findVertex(0), path);
+        Run res;
+        res.cost = graph.tspTriangular(path);
+        res.tour = idsOf(path);
+        return res;
+    }
+
+    /**
+     * Solves seeded random sub-tours with one thread, with several and on a pool with a queue of one task, which must
+     * all give the same tours; the run holds the total cost and the tours one after the other, each closed by -1.
+     */
+    Run batch(Graph &graph, const Options &options, std::string &error) {
+        std::mt19937 rng(1);
+        int n = graph.getNumVertex();
+        std::vector<std::vector<int>> subsets(256);
+        for (auto &subset : subsets) {
+            int k = std::min(n, 4 + (int) (rng() % 14));
+            std::vector<int> ids(n);
+            for (int i = 0; i < n; i++) ids[i] = i;
+            for (int i = 0; i < k; i++) std::swap(ids[i], ids[i + rng() % (n - i)]);
+            subset.assign(ids.begin(), ids.begin() + k);
+        }
+
+        BatchOptions sequential;
+        sequential.threads = 1;
+        BatchOptions parallel;
+        parallel.threads = options.threads;
+        parallel.chunk = 8;
+        std::vector<BatchResult> one = BatchSolver::solve(graph, subsets, sequential);
+        std::vector<BatchResult> many = BatchSolver::solve(graph, subsets, parallel);
+        // a pool that queues one task at a time rejects most chunks, which must still be solved
+        ThreadPool bounded(options.threads, 1);
+        std::vector<BatchResult> rejected = BatchSolver::solve(graph, subsets, parallel, bounded);
+
+        Run res;
+        res.cost = 0;
+        for (size_t i = 0; i < subsets.size(); i++) {
+            if (one[i].cost != many[i].cost || one[i].tour != many[i].tour) {
+                error = "sub-tour " + std::to_string(i) + " differs between 1 and " + std::to_string(options.threads)
+                        + " threads";
+            }
+            if (one[i].cost != rejected[i].cost || one[i].tour != rejected[i].tour) {
+                error = "sub-tour " + std::to_string(i) + " differs on a pool with a queue of 1 task";
+            }
+            if (one[i].cost > 0) res.cost += one[i].cost;
+            res.tour.insert(res.tour.end(), one[i].tour.begin(), one[i].tour.end());
+            res.tour.push_back(-1);
+        }
+        return res;
+    }
+
+    std::vector<Algorithm> algorithms() {
+        return {
+            {"bt", true, 13, [](Graph &graph, const Options&) {
+                std::vector<Vertex*> path;
+                Run res;
+                res.cost = graph.tspBT(path);
+                res.tour = idsOf(path);
+                return res;
+            }},
+            {"exact", true, ExactSolvers::maxSize, [](Graph &graph, const Options&) {
+                std::vector<Vertex*> path;
+                Run res;
+                res.cost = graph.tspExact(path);
+                res.tour = idsOf(path);
+                return res;
+            }},
+            {"tah", false, 0, [](Graph &graph, const Options&) { return triangular(graph); }},
+            {"nn", false, 0, [](Graph &graph, const Options&) {
+                return heuristic(graph, TourSeed::NearestNeighbour, MoveKernel::GraphLookup, false);
+            }},
+            {"greedy", false, 0, [](Graph &graph, const Options&) {
+                return heuristic(graph, TourSeed::GreedyEdge, MoveKernel::MatrixScalar, false);
+            }},
+            {"sfc", false, 0, [](Graph &graph, const Options&) {
+                return heuristic(graph, TourSeed::SpaceFillingCurve, MoveKernel::MatrixSimd, false);
+            }},
+            {"oropt", false, 0, [](Graph &graph, const Options&) {
+                return heuristic(graph, TourSeed::NearestNeighbour, MoveKernel::MatrixSimd, true);
+            }},
+            {"sa", false, 0, [](Graph &graph, const Options &options) {
+                return metaheuristic(graph, MetaheuristicKind::SimulatedAnnealing, options);
+            }},
+            {"gls", false, 0, [](Graph &graph, const Options &options) {
+                return metaheuristic(graph, MetaheuristicKind::GuidedLocalSearch, options);
+            }},
+            {"ils", false, 0, [](Graph &graph, const Options &options) {
+                return metaheuristic(graph, MetaheuristicKind::IteratedLocalSearch, options);
+            }},
+        };
+    }
+
+    /**
+     * Checks that a tour visits every vertex once starting at vertex 0, that each step (closing one included) exists
+     * and that the steps add up to the cost given by the algorithm.
+     * @return Empty if the tour is valid, the problem otherwise
+     */
+    std::string validate(Graph &graph, const Run &run, bool edgesOnly, double tolerance) {
+        int n = graph.getNumVertex();
+        if ((int) run.tour.size() != n) return "tour has " + std::to_string(run.tour.size()) + " of " +
+                                                std::to_string(n) + " vertices";
+        if (run.tour[0] != 0) return "tour does not start at vertex 0";
+        std::vector<bool> seen(n, false);
+        double cost = 0;
+        for (int i = 0; i < n; i++) {
+            int id = run.tour[i];
+            if (id < 0 || id >= n || seen[id]) return "vertex " + std::to_string(id) + " is repeated or unknown";
+            seen[id] = true;
+            Vertex* from = graph.findVertex(id);
+            Vertex* to = graph.findVertex(run.tour[(i + 1) % n]);
+            double d = edgesOnly ? graph.dist(from, to) : graph.calculateDistance(from, to);
+            if (d == -1.0) return "no edge from " + std::to_string(id) + " to " + std::to_string(to->getId());
+            cost += d;
+        }
+        if (std::fabs(cost - run.cost) > tolerance * std::max(1.0, std::fabs(cost)))
+            return "steps add up to " + std::to_string(cost) + ", not the reported " + std::to_string(run.cost);
+        return "";
+    }
+
+    std::string key(const std::string &dataset, const std::string &algorithm) {
+        return dataset + "," + algorithm;
+    }
+
+    /**
+     * Golden file: one line per dataset and algorithm with the cost, the time in milliseconds and the tour.
+     */
+    std::map<std::string, Run> readGolden(const std::string &path) {
+        std::map<std::string, Run> golden;
+        std::ifstream in(path);
+        for (std::string line; std::getline(in, line);) {
+            if (line.empty() || line[0] == '#') continue;
+            std::stringstream ss(line);
+            std::string dataset, algorithm, cost, ms, tour;
+            if (!std::getline(ss, dataset, ',') || !std::getline(ss, algorithm, ',') || !std::getline(ss, cost, ',')
+                || !std::getline(ss, ms, ',')) continue;
+            std::getline(ss, tour);
+            Run run;
+            try {
+                run.cost = std::stod(cost);
+                run.ms = std::stod(ms);
+                std::stringstream ids(tour);
+                for (int id; ids >> id;) run.tour.push_back(id);
+            } catch (const std::exception&) {
+                continue;
+            }
+            golden[key(dataset, algorithm)] = run;
+        }
+        return golden;
+    }
+
+    bool writeGolden(const std::string &path, const std::map<std::string, Run> &golden) {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << "# dataset,algorithm,cost,milliseconds,tour\n";
+        char number[64];
+        for (auto &entry : golden) {
+            std::snprintf(number, sizeof(number), "%.17g,%.3f", entry.second.cost, entry.second.ms);
+            out << entry.first << "," << number << ",";
+            for (size_t i = 0; i < entry.second.tour.size(); i++) out << (i == 0 ? "" : " ") << entry.second.tour[i];
+            out << "\n";
+        }
+        return true;
+    }
+
+    void report(Counts &counts, const std::string &status, const std::string &dataset, const std::string &algorithm,
+                const std::string &detail) {
+        if (status == "PASS") counts.passed++;
+        else if (status == "FAIL") counts.failed++;
+        else counts.skipped++;
+        std::printf("%-4s  %-20s %-7s %s\n", status.c_str(), dataset.c_str(), algorithm.c_str(), detail.c_str());
+        std::fflush(stdout);
+    }
+
+    /**
+     * Runs an algorithm options.repeat times (batch does its own parallel comparison) and checks the runs against
+     * each other, the tour against the graph and, unless recording, the result against the golden one.
+     */
+    void check(Graph &graph, const Dataset &dataset, const Algorithm &algorithm, const Options &options,
+               std::map<std::string, Run> &golden, Counts &counts) {
+        std::string error;
+        Run first;
+        for (int r = 0; r < options.repeat && error.empty(); r++) {
+            auto start = std::chrono::steady_clock::now();
+            Run run = algorithm.name == "batch" ? batch(graph, options, error) : algorithm.run(graph, options);
+            run.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (r == 0) first = run;
+            else if (run.cost != first.cost || run.tour != first.tour) error = "run " + std::to_string(r + 1) +
+                                                                               " differs from run 1";
+            else first.ms = std::min(first.ms, run.ms);
+        }
+        if (error.empty() && algorithm.name != "batch") {
+            if (first.cost == -1.0) error = "no tour found";
+            else error = validate(graph, first, algorithm.edgesOnly, options.tolerance);
+        }
+        char detail[160];
+        std::snprintf(detail, sizeof(detail), "cost=%.17g ms=%.1f", first.cost, first.ms);
+        if (!error.empty()) {
+            report(counts, "FAIL", dataset.name, algorithm.name, error);
+            return;
+        }
+
+        std::string id = key(dataset.name, algorithm.name);
+        if (options.record) {
+            golden[id] = first;
+            report(counts, "PASS", dataset.name, algorithm.name, std::string(detail) + " recorded");
+            return;
+        }
+        auto expected = golden.find(id);
+        if (expected == golden.end()) {
+            report(counts, "SKIP", dataset.name, algorithm.name, std::string(detail) + " no golden result");
+            return;
+        }
+        const Run &gold = expected->second;
+        if (std::fabs(first.cost - gold.cost) > options.tolerance * std::max(1.0, std::fabs(gold.cost))) {
+            std::snprintf(detail, sizeof(detail), "cost %.17g differs from golden %.17g", first.cost, gold.cost);
+            report(counts, "FAIL", dataset.name, algorithm.name, detail);
+        } else if (first.tour != gold.tour) {
+            report(counts, "FAIL", dataset.name, algorithm.name, "tour differs from golden");
+        } else if (gold.ms >= options.minMs && first.ms > options.slowdown * gold.ms) {
+            std::snprintf(detail, sizeof(detail), "%.1f ms is more than %.2g times the baseline of %.1f ms",
+                          first.ms, options.slowdown, gold.ms);
+            report(counts, "FAIL", dataset.name, algorithm.name, detail);
+        } else {
+            report(counts, "PASS", dataset.name, algorithm.name, detail);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+
+    std::vector<Algorithm> all = algorithms();
+    all.push_back({"batch", false, 0, nullptr});
+    std::map<std::string, Run> golden = readGolden(options.goldenPath);
+    if (!options.record && golden.empty())
+        std::cout << "No golden results in " << options.goldenPath << "; run with --record to create them."
+                  << std::endl;
+
+    Counts counts;
+    for (const Dataset &dataset : datasets(options)) {
+        if (!exists(dataset.edgesPath)) {
+            report(counts, "SKIP", dataset.name, "-", "missing " + dataset.edgesPath);
+            continue;
+        }
+        std::string nodesPath = exists(dataset.nodesPath) ? dataset.nodesPath : "";
+        Graph graph;
+        try {
+            graph = GraphLoader::load(dataset.edgesPath, nodesPath).graph;
+        } catch (const std::exception &e) {
+            report(counts, "FAIL", dataset.name, "-", "cannot be read: " + std::string(e.what()));
+            continue;
+        }
+
+        for (const Algorithm &algorithm : all) {
+            if (!options.only.empty() &&
+                std::find(options.only.begin(), options.only.end(), algorithm.name) == options.only.end()) continue;
+            int limit = algorithm.maxVertices != 0 ? algorithm.maxVertices : options.maxVertices;
+            if (graph.getNumVertex() > limit) {
+                report(counts, "SKIP", dataset.name, algorithm.name, "more than " + std::to_string(limit) +
+                                                                     " vertices");
+            } else if (algorithm.name == "sfc" && !graph.hasCoords()) {
+                report(counts, "SKIP", dataset.name, algorithm.name, "needs coordinates");
+            } else if (algorithm.name != "batch" && !graph.tourPossible(algorithm.edgesOnly)) {
+                report(counts, "SKIP", dataset.name, algorithm.name, "no tour: " + graph.connectivity().reason());
+            } else {
+                check(graph, dataset, algorithm, options, golden, counts);
+            }
+        }
+    }
+
+    if (options.record) {
+        makeParents(options.goldenPath);
+        if (!writeGolden(options.goldenPath, golden)) {
+            std::cerr << "Cannot write " << options.goldenPath << std::endl;
+            return 1;
+        }
+        std::cout << "Golden results written to " << options.goldenPath << std::endl;
+    }
+    std::cout << counts.passed << " passed, " << counts.failed << " failed, " << counts.skipped << " skipped"
+              << std::endl;
+    return counts.failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Load test for `feup_da_proj2 --server --socket PATH`.
+
+Opens several connections to the server, sends solve requests on each of them and
+prints the client-side latency percentiles and throughput, followed by the server's
+own STATS line.
+
+Example:
+    ./feup_da_proj2 --server --socket /tmp/tsp.sock --threads 4 &
+    scripts/loadtest.py /tmp/tsp.sock --load g900 edges.csv nodes.csv \\
+        --graph g900 --algorithm 2opt --requests 200 --connections 8
+"""
+import argparse
+import socket
+import threading
+import time
+
+
+def connect(path):
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(path)
+    return sock, sock.makefile("r")
+
+
+def request(sock, reader, line):
+    sock.sendall((line + "\n").encode())
+    return reader.readline().strip()
+
+
+def worker(path, args, count, latencies, errors, lock):
+    """Sends `count` solve requests on one connection, then waits for all their results.
+
+    Results are sent as soon as they are ready, so a RESULT may arrive before the
+    QUEUED reply of its own request; both are matched by request id.
+    """
+    sock, reader = connect(path)
+    sent_at = []
+    for i in range(count):
+        sent_at.append(time.monotonic())
+        sock.sendall(("solve %s %s %d %d\n" % (args.graph, args.algorithm, args.budget, i + 1)).encode())
+
+    replies, queued, finished = 0, {}, {}
+    while replies < count or len(finished) < len(queued):
+        reply = reader.readline().strip()
+        if not reply:
+            break
+        words = reply.split()
+        if words[0] == "RESULT":
+            finished[words[1]] = (time.monotonic(), "ERROR" in reply)
+        elif words[0] == "QUEUED":
+            queued[words[1]] = sent_at[replies]
+            replies += 1
+        else:
+            with lock:
+                errors.append(reply)
+            replies += 1
+
+    with lock:
+        for request_id, start in queued.items():
+            end, failed = finished.get(request_id, (None, True))
+            if end is not None:
+                latencies.append((end - start) * 1000)
+            if failed:
+                errors.append("RESULT %s failed" % request_id)
+    sock.sendall(b"quit\n")
+    sock.close()
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p * len(values)))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("socket")
+    parser.add_argument("--load", nargs="+", metavar=("NAME", "FILES"),
+                        help="load a graph first: name, edges file and optional nodes file")
+    parser.add_argument("--graph", required=True)
+    parser.add_argument("--algorithm", default="2opt")
+    parser.add_argument("--budget", type=int, default=100)
+    parser.add_argument("--requests", type=int, default=100)
+    parser.add_argument("--connections", type=int, default=4)
+    args = parser.parse_args()
+
+    sock, reader = connect(args.socket)
+    if args.load:
+        print(request(sock, reader, "load " + " ".join(args.load)))
+
+    latencies, errors, lock = [], [], threading.Lock()
+    per_connection = [args.requests // args.connections] * args.connections
+    for i in range(args.requests % args.connections):
+        per_connection[i] += 1
+
+    start = time.monotonic()
+    threads = [threading.Thread(target=worker, args=(args.socket, args, count, latencies, errors, lock))
+               for count in per_connection]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    elapsed = time.monotonic() - start
+
+    print("requests=%d errors=%d elapsed_s=%.2f throughput_per_s=%.1f" %
+          (len(latencies), len(errors), elapsed, len(latencies) / elapsed if elapsed > 0 else 0))
+    print("latency_ms p50=%.1f p95=%.1f p99=%.1f max=%.1f" %
+          (percentile(latencies, 0.5), percentile(latencies, 0.95), percentile(latencies, 0.99),
+           max(latencies) if latencies else 0))
+    for error in errors[:5]:
+        print(error)
+    print(request(sock, reader, "stats"))
+    sock.close()
+
+
+if __name__ == "__main__":
+    main()